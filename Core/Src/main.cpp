@@ -30,17 +30,47 @@
 #include "HW_can.hpp"
 #include "GM6020.hpp"
 #include "PID.hpp"
-#include <math.h>
+#include "PidStore.hpp"
+#include "Dwt.hpp"
+#include "Clock.hpp"
+#include "FeedbackSync.hpp"
+#include "BoardLink.hpp"
+#include "AutoTune.hpp"
+#include "Scheduler.hpp"
+#include "Coro.hpp"
+#include "CpuLoad.hpp"
+#include "RefGen.hpp"
 
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
 /* USER CODE BEGIN PTD */
+struct BoardLinkState {
+  float gimbal_yaw;
+  float gimbal_pitch;
+  float chassis_vx;
+  float chassis_vy;
+  float chassis_wz;
+  uint8_t mode;
+  PidGainsRecord speed_gains;  // 对端下发的速度环增益，只有增益和限幅
+  uint8_t speed_params_seq;    // 对端每下发一组新参数加1，0表示不下发
+};
+
+/*CAN命令帧(CAN_COMMAND_RX_ID)的命令码，data[0]*/
+enum CanCommand : uint8_t {
+  kCanCmdSpeedTune = 1,       // 开始速度环自整定
+  kCanCmdSpeedRollback = 2,   // 换回上一组速度环参数
+};
 
 /* USER CODE END PTD */
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
+#define CONTROL_FEEDBACK_SYNC 1  // 1: 电机反馈到齐后立即执行速度环  0: 调度器在TIM6中断里按周期执行
+#define SPEED_TUNE_RULE kAutoTuneTyreusLuyben  // 速度环自整定结果的计算规则
+#define TELEMETRY_PERIOD 10       // 串口遥测周期(ms)
+#define UART1_TX_DONE (1u << 0)   // uart1_flag：USART1 DMA发送完成
+#define BOARD_LINK_PERIOD 5      // 板间同步周期(ms)，总线繁忙时由带宽调节放大到最多40ms
 
 /* USER CODE END PD */
 
@@ -52,18 +82,254 @@
 /* Private variables ---------------------------------------------------------*/
 
 /* USER CODE BEGIN PV */
-uint32_t tick;  //全局变量tick，当前时间
-extern GM6020 motors[7];
+volatile uint32_t tick;  //全局变量tick，TIM6中断中每1ms加1；需要更高分辨率的时间用Clock_Now()
+
+static PidParams speed_pidparams = {0.003f, 0.1f, 0.00001f, 10.0f, 2.0f};
+static Pid speed_PID(speed_pidparams);
+static PidStore speed_store(speed_PID);         // 在线修改速度环参数，在控制周期边界换入
+uint8_t speed_params_rollback;                  // 调试器或CAN命令写1换回上一组速度环参数
+static uint8_t speed_params_seq;                // 已经接受的对端参数序号
+static RefGen speed_ref(0.001f);                // 速度参考值，按tick(1ms)采样
+static DtMeter speed_dt(168000000, Dwt_Cycles);  // 速度环实际采样周期，168MHz主频
+static FeedbackSync speed_sync(1u << 0, 2);  // 速度环只控制motors[0]，反馈超过2ms未到齐时由TIM6补调度
+static AutoTune speed_tune;
+static const AutoTuneConfig speed_tune_config = {0, 0, 0.5f, 5.0f, 4, 5.0f};  // 继电幅值0.5，回差5rpm，平均4个周期
+uint8_t speed_tune_start;                    // 调试器或CAN命令写1开始速度环自整定，完成后增益经speed_store换入speed_PID
+static bool speed_tune_staged;               // 本次整定结果已交给speed_store，只由SpeedParams_Poll读写
+uint32_t speed_loop_latency;                 // 反馈到达到发出控制帧的CPU周期数，只在反馈触发时记录，供调试观察
+uint32_t pid_calc_cycles;                    // 一次pidCalc的CPU周期数，供调试观察
+
+BoardLinkState link_local;   // 本板发给对端的状态，由应用层更新
+BoardLinkState link_remote;  // 对端同步过来的状态
+static constexpr BoardLinkField link_local_fields[] = {
+    BOARD_LINK_FIELD(link_local.gimbal_yaw), BOARD_LINK_FIELD(link_local.gimbal_pitch),
+    BOARD_LINK_FIELD(link_local.chassis_vx), BOARD_LINK_FIELD(link_local.chassis_vy),
+    BOARD_LINK_FIELD(link_local.chassis_wz), BOARD_LINK_FIELD(link_local.mode),
+    BOARD_LINK_FIELD(link_local.speed_gains), BOARD_LINK_FIELD(link_local.speed_params_seq)};
+static constexpr BoardLinkField link_remote_fields[] = {
+    BOARD_LINK_FIELD(link_remote.gimbal_yaw), BOARD_LINK_FIELD(link_remote.gimbal_pitch),
+    BOARD_LINK_FIELD(link_remote.chassis_vx), BOARD_LINK_FIELD(link_remote.chassis_vy),
+    BOARD_LINK_FIELD(link_remote.chassis_wz), BOARD_LINK_FIELD(link_remote.mode),
+    BOARD_LINK_FIELD(link_remote.speed_gains), BOARD_LINK_FIELD(link_remote.speed_params_seq)};
+static_assert(BoardLink_Fits(link_local_fields, sizeof(link_local_fields) / sizeof(link_local_fields[0])),
+              "board link state does not fit in one message");
+static_assert(BoardLink_Fits(link_remote_fields, sizeof(link_remote_fields) / sizeof(link_remote_fields[0])),
+              "board link state does not fit in one message");
+static BoardLinkTx board_link_tx(link_local_fields, 40);  // 每40条消息发送一次全部字段
+static BoardLinkRx board_link_rx(link_remote_fields);
+static CoFlag uart1_flag;
+static CoCanQueue command_queue;  // CAN接收中断放入命令帧，Command_Task取出处理
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 /* USER CODE BEGIN PFP */
+static void SpeedLoop_Step(float T);
+static void BoardLink_Poll(void);
+static void SpeedParams_Poll(void);
+static void SpeedLoop_Task(void);
+static void Background_Task(void);
+static CoTask Telemetry_Task(void);
+static CoTask CanRecovery_Task(void);
+static CoTask Command_Task(void);
 
 /* USER CODE END PFP */
 
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN 0 */
+/**
+  * @brief  速度环的一步：计算PID并立即发出控制帧
+  * @param  T为名义控制周期(s)，实际周期由speed_dt测量
+  * @retval None
+  */
+static void SpeedLoop_Step(float T)
+{
+  float speed_expect = speed_ref.sample(tick);
+  float speed_real = motors[0].vel();
+
+  speed_store.commit();   // 在线修改的参数在周期开始时换入
+
+  if (speed_tune_start) {
+    speed_tune_start = 0;
+    speed_tune.start(speed_tune_config);
+  }
+
+  uint32_t pid_start = Dwt_Cycles();
+  float current_output;
+  if (speed_tune.running()) {   // 自整定期间由继电器代替PID输出
+    current_output = speed_tune.step(speed_real, speed_dt.measure(T));
+    speed_PID.track(speed_expect, speed_real, current_output);   // 跟踪继电器输出，整定结束后无扰切回PID
+  } else {   // 整定出的增益由SpeedParams_Poll经speed_store换入
+    current_output = speed_PID.pidCalc(speed_expect, speed_real, speed_dt, T);
+  }
+  pid_calc_cycles = Dwt_Cycles() - pid_start;
+  motors[0].setInput(current_output);
+
+  CAN_SendMotorGroup(kTopoMotorGroup[0]);  // 与motors[0]同组的电机合成一帧发出
+}
+
+/**
+  * @brief  板间同步：按周期打包变化的字段，并在有空闲邮箱时发出分片
+  * @retval None
+  * @note   发送周期由带宽调节决定，至少保留一个发送邮箱给控制帧
+  */
+static void BoardLink_Poll(void)
+{
+  CanGovernor *governor = CanBus_GetGovernor(&hcan1);
+  if (governor->admit(kCanClassBoardLink, tick, !board_link_tx.keyDue()) &&
+      board_link_tx.update())   // 字段没有变化时不排队，也不计为一次发送
+    governor->charge(kCanClassBoardLink);
+
+  uint8_t data[8];
+  uint8_t len;
+  while (board_link_tx.peekFrame(data, &len) &&
+         CAN_TrySend_Msg(&hcan1, data, BOARD_LINK_TX_ID, len, 1))
+    board_link_tx.popFrame();
+}
+
+/**
+  * @brief  在线修改速度环参数：接受对端通过板间同步下发的参数，或按调试器请求回滚
+  * @retval None
+  * @note   在Background_Task(PendSV)中运行，是speed_store唯一的写入方，stage、rollback只在这里调用；
+  *         TIM6中的commit可以打断它，stage先写数据再置标志，commit只会换入完整的一组参数
+  */
+static void SpeedParams_Poll(void)
+{
+  if (speed_params_rollback) {
+    speed_params_rollback = 0;
+    speed_store.rollback();
+  }
+
+  // 自整定的状态只由控制上下文修改，这里只读；完成后把增益交给speed_store，下一个控制周期commit换入
+  if (speed_tune.state() != kAutoTuneDone) {
+    speed_tune_staged = false;
+  } else if (!speed_tune_staged) {
+    PidParams params = speed_store.active();
+    speed_tune_staged = speed_tune.result(&params, SPEED_TUNE_RULE) && speed_store.stage(params);
+  }
+
+  if (!board_link_rx.synced())
+    return;
+
+  // link_remote在CAN接收中断中更新，屏蔽CAN中断后拷贝，避免读到一半被改写
+  uint32_t basepri = __get_BASEPRI();
+  __set_BASEPRI(1 << (8 - __NVIC_PRIO_BITS));
+  uint8_t seq = link_remote.speed_params_seq;
+  PidGainsRecord gains = link_remote.speed_gains;
+  __set_BASEPRI(basepri);
+
+  if (seq == 0 || seq == speed_params_seq)
+    return;
+  PidParams params = speed_store.active();   // 没有下发的参数沿用当前值
+  if (!PidGains_Unpack(gains, &params))
+    speed_params_seq = seq;   // 版本不符或数值非法，丢弃这一组，不再重复检查
+  else if (speed_store.stage(params))
+    speed_params_seq = seq;
+}
+
+/**
+  * @brief  速度环的调度任务，在TIM6中断中运行
+  * @retval None
+  * @note   反馈同步时只在反馈缺失时补调度，否则每2ms运行一次
+  */
+static void SpeedLoop_Task(void)
+{
+#if CONTROL_FEEDBACK_SYNC
+  uint32_t basepri = __get_BASEPRI();
+  __set_BASEPRI(1 << (8 - __NVIC_PRIO_BITS));  // 屏蔽CAN接收中断，避免与反馈触发的速度环重入
+  if (speed_sync.poll(tick))   // 反馈缺失，按TIM6调度补一次
+    SpeedLoop_Step(0.001f * 2);
+  __set_BASEPRI(basepri);
+#else
+  SpeedLoop_Step(0.001f * 2);
+#endif
+}
+
+/**
+  * @brief  后台任务，在PendSV中运行，可以被除SysTick以外的中断抢占
+  * @retval None
+  * @note   运行期间HAL_GetTick不增加，需要等待超时的工作(CAN恢复)放在协程中
+  */
+static void Background_Task(void)
+{
+  CanBus_GovernorPoll();  // 统计总线负载，调整非关键帧的发送频率
+  BoardLink_Poll();       // 板间状态同步
+  SpeedParams_Poll();     // 在线修改速度环参数
+}
+
+/**
+  * @brief  串口遥测协程：周期性地通过USART1 DMA发出速度环的状态
+  * @retval None
+  * @note   帧格式：0xA5 0x5A，速度(int16 rpm)，电流(int16 mA)，温度，速度环延迟(uint16 us)，
+  *         pidCalc耗时(uint16周期)，前面字节的累加和；多字节数据低字节在前
+  */
+static CoTask Telemetry_Task(void)
+{
+  static uint8_t frame[12];
+  while (1) {
+    co_await CoDelay(TELEMETRY_PERIOD);
+
+    int16_t vel = motors[0].rawVel();
+    int16_t current = static_cast<int16_t>(motors[0].current() * 1000.0f);
+    uint16_t latency = static_cast<uint16_t>(speed_loop_latency / 168);
+    uint16_t cycles = static_cast<uint16_t>(pid_calc_cycles);
+    frame[0] = 0xA5;
+    frame[1] = 0x5A;
+    frame[2] = vel & 0xFF;
+    frame[3] = (vel >> 8) & 0xFF;
+    frame[4] = current & 0xFF;
+    frame[5] = (current >> 8) & 0xFF;
+    frame[6] = static_cast<uint8_t>(motors[0].temp());
+    frame[7] = latency & 0xFF;
+    frame[8] = latency >> 8;
+    frame[9] = cycles & 0xFF;
+    frame[10] = cycles >> 8;
+    uint8_t sum = 0;
+    for (uint8_t i = 0; i < 11; i++)
+      sum += frame[i];
+    frame[11] = sum;
+
+    if (HAL_UART_Transmit_DMA(&huart1, frame, sizeof(frame)) == HAL_OK)
+      co_await uart1_flag.wait(UART1_TX_DONE);   // 发完之前不能改frame
+  }
+}
+
+/**
+  * @brief  CAN总线恢复协程：每1ms检查一次总线是否需要恢复
+  * @retval None
+  * @note   重新初始化要按HAL_GetTick等待超时，必须在线程模式运行；
+  *         PendSV与SysTick同为最低优先级，放在Background_Task中时tick不再增加，超时等待不会结束
+  */
+static CoTask CanRecovery_Task(void)
+{
+  while (1) {
+    co_await CoDelay(1);
+    CanBus_RecoveryPoll();
+  }
+}
+
+/**
+  * @brief  CAN命令协程：等待命令帧，按命令码设置对应的请求，由控制上下文在周期边界执行
+  * @retval None
+  */
+static CoTask Command_Task(void)
+{
+  while (1) {
+    CoCanFrame frame = co_await command_queue.receive();
+    if (frame.len == 0)
+      continue;
+    switch (frame.data[0]) {
+      case kCanCmdSpeedTune:
+        speed_tune_start = 1;
+        break;
+      case kCanCmdSpeedRollback:
+        speed_params_rollback = 1;
+        break;
+      default:
+        break;
+    }
+  }
+}
 
 /* USER CODE END 0 */
 
@@ -107,27 +373,27 @@ int main(void)
   MX_USART6_UART_Init();
   MX_USART1_UART_Init();
   /* USER CODE BEGIN 2 */
-  CanFilter_Init(&hcan1);
-  HAL_CAN_Start(&hcan1);  // 启动CAN
-  HAL_CAN_ActivateNotification(&hcan1, CAN_IT_RX_FIFO0_MSG_PENDING);  // 启动接收中断
+  Dwt_Init();  // CAN接收时间戳依赖DWT周期计数
+  Clock_Init(168000000);  // 64位时间基准，168MHz主频
+  speed_ref.setSine(250, 0.2f);  // 幅值250rpm、0.2Hz的正弦
+  CpuLoad_Init(1000);  // 每秒统计一次CPU占用率
+  CanBus_Start(&hcan1);  // 启动CAN，使能接收中断和错误中断
+  CanBus_GetGovernor(&hcan1)->setPolicy(kCanClassBoardLink,
+                                        {kCanThrottleRate, BOARD_LINK_PERIOD, 40, 0});
+#if CONTROL_FEEDBACK_SYNC
+  Sched_Register(SpeedLoop_Task, 1, 0, 0, kSchedIsr);      // 每个tick检查反馈是否缺失
+#else
+  Sched_Register(SpeedLoop_Task, 2, 0, 0, kSchedIsr);
+#endif
+  Sched_Register(Background_Task, 1, 0, 1, kSchedPendSV);
+  Sched_Register(CpuLoad_Update, 1, 0, 2, kSchedIsr);
+  Sched_Start(168000000 / 1000);   // TIM6每1ms一个tick
+  Coro_Spawn(Telemetry_Task());
+  Coro_Spawn(CanRecovery_Task());
+  Coro_Spawn(Command_Task());
   HAL_TIM_Base_Start_IT(&htim6);
 
 
-  PidParams speed_pidparams;
-  speed_pidparams.kp = 0.003f;
-  speed_pidparams.ki = 0.1f;
-  speed_pidparams.kd = 0.00001f;
-  speed_pidparams.integral_limit = 10.0f;
-  speed_pidparams.output_limit = 2.0f;
-  Pid speed_PID(speed_pidparams);
-
-
-
-  uint32_t last_speed_time = tick;
-  float current_output;
-  float T_speed = 0.001f;
-
-
   /* USER CODE END 2 */
 
   /* Infinite loop */
@@ -136,22 +402,10 @@ int main(void)
   {
     /* USER CODE END WHILE */
 
-  if ((tick - last_speed_time) >= 2)  // 速度 PID
-    {
-      float speed_expect = 250 * sin(2 * M_PI * 0.2 * tick * 0.001);
-      float speed_real = motors[0].vel();
-
-      current_output = speed_PID.pidCalc(speed_expect, speed_real, T_speed);
-      motors[0].setInput(current_output);
-
-      uint8_t can_data[8];
-      if (!motors[0].encode(can_data))
-        Error_Handler();
-
-      CAN_Send_Msg(&hcan1, can_data, motors[0].txId(), 8);
-      last_speed_time = tick;
-    }
     /* USER CODE BEGIN 3 */
+    // 周期任务都由调度器在TIM6中断和PendSV中运行，主循环只运行后台协程(遥测、CAN恢复、命令)，然后休眠到下一个中断
+    Coro_Run(tick);
+    CpuLoad_Idle();
   }
   /* USER CODE END 3 */
 }
@@ -204,9 +458,38 @@ void SystemClock_Config(void)
 /* USER CODE BEGIN 4 */
 void  HAL_TIM_PeriodElapsedCallback (TIM_HandleTypeDef   *htim) {
   if (htim->Instance == TIM6) {	
-    tick ++;    //产生0.5ms的中断，每0.5mstick加1
+    Clock_Tick();  // 先更新时间基准，之后的任务读到的都是新快照
+    tick = tick + 1;    //产生1ms的中断，每1mstick加1
+    Sched_Tick(tick);
+  }
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+  if (huart->Instance == USART1)
+    uart1_flag.set(UART1_TX_DONE);
+}
+
+void CAN_BoardLinkCallback(CAN_HandleTypeDef *hcan, uint8_t *data, uint8_t len)
+{
+  board_link_rx.onFrame(data, len);
+}
+
+void CAN_CommandCallback(CAN_HandleTypeDef *hcan, uint32_t id, uint8_t *data, uint8_t len)
+{
+  command_queue.push(id, data, len);   // 队列满时丢弃，计入command_queue.dropped()
+}
+
+#if CONTROL_FEEDBACK_SYNC
+void CAN_MotorFeedbackCallback(CAN_HandleTypeDef *hcan, uint8_t motor_index)
+{
+  if (speed_sync.feedback(motor_index, tick)) {
+    SpeedLoop_Step(0.001f);  // GM6020反馈周期为1ms
+    // 接收时间戳在本中断中刚写入，直接读不会被打断；TIM6补调度时反馈已经过期，不记录延迟
+    speed_loop_latency = static_cast<uint32_t>(Clock_Now() - motors[motor_index].rxStamp());
   }
 }
+#endif
 /* USER CODE END 4 */
 
 /**
@@ -0,0 +1,113 @@
+#include "AutoTune.hpp"
+#include "math.h"
+
+/**
+ * @brief   开始一次整定，调用前应先停止该电机的PID
+ * @param   config为继电器参数
+ * @retval  None
+ */
+void AutoTune::start(const AutoTuneConfig &config)
+{
+  config_ = config;
+  if (config_.cycles == 0)
+    config_.cycles = 1;
+  high_ = true;
+  time_ = last_rise_ = 0;
+  peak_max_ = -1e9f;
+  peak_min_ = 1e9f;
+  rises_ = 0;
+  period_sum_ = amp_sum_ = 0;
+  samples_ = 0;
+  ku_ = tu_ = 0;
+  state_ = kAutoTuneRunning;
+}
+
+/**
+ * @brief   运行一个控制周期
+ * @param   fdb为反馈值
+ * @param   T为本周期的时间(s)
+ * @retval  发给电机的输出，整定结束或失败后输出bias
+ */
+float AutoTune::step(const float fdb, const float T)
+{
+  if (state_ != kAutoTuneRunning)
+    return state_ == kAutoTuneIdle ? 0 : config_.bias;
+
+  time_ += T;
+  if (time_ > config_.timeout) {
+    state_ = kAutoTuneFailed;
+    return config_.bias;
+  }
+
+  if (fdb > peak_max_) peak_max_ = fdb;
+  if (fdb < peak_min_) peak_min_ = fdb;
+
+  float error = config_.setpoint - fdb;
+  if (high_ && error < -config_.hysteresis) {
+    high_ = false;
+  } else if (!high_ && error > config_.hysteresis) {
+    high_ = true;
+    // 每次切到高输出算一个完整周期，第一个周期是过渡过程
+    if (rises_++ > 0) {
+      period_sum_ += time_ - last_rise_;
+      amp_sum_ += (peak_max_ - peak_min_) * 0.5f;
+      samples_++;
+    }
+    last_rise_ = time_;
+    peak_max_ = -1e9f;
+    peak_min_ = 1e9f;
+
+    if (samples_ >= config_.cycles) {
+      float a = amp_sum_ / samples_;
+      float h = config_.hysteresis;
+      if (a <= h) {           // 振荡没有越过回差，数据不可信
+        state_ = kAutoTuneFailed;
+        return config_.bias;
+      }
+      tu_ = period_sum_ / samples_;
+      ku_ = 4.0f * config_.amplitude / (static_cast<float>(M_PI) * sqrtf(a * a - h * h));
+      state_ = kAutoTuneDone;
+      return config_.bias;
+    }
+  }
+
+  return high_ ? config_.bias + config_.amplitude : config_.bias - config_.amplitude;
+}
+
+/**
+ * @brief   按整定规则计算增益，写入params的kp、ki、kd，其它参数不变
+ * @param   params为要更新的参数，通常是控制器当前的参数
+ * @param   rule为整定规则
+ * @retval  整定未完成时返回false，params不变
+ * @note    结果由调用方换入控制器，例如PidStore::stage，或Pid::transferParams无扰切换
+ */
+bool AutoTune::result(PidParams *params, AutoTuneRule rule)
+{
+  if (state_ != kAutoTuneDone)
+    return false;
+
+  float kp, ti, td;
+  switch (rule) {
+    case kAutoTuneZieglerNicholsPI:
+      kp = 0.45f * ku_;
+      ti = tu_ / 1.2f;
+      td = 0;
+      break;
+    case kAutoTuneTyreusLuyben:
+      kp = ku_ / 2.2f;
+      ti = 2.2f * tu_;
+      td = tu_ / 6.3f;
+      break;
+    case kAutoTuneZieglerNichols:
+    default:
+      kp = 0.6f * ku_;
+      ti = tu_ * 0.5f;
+      td = tu_ * 0.125f;
+      break;
+  }
+
+  params->kp = kp;
+  params->ki = kp / ti;   // Pid是并联形式，ki = kp/Ti，kd = kp*Td
+  params->kd = kp * td;
+  return true;
+}
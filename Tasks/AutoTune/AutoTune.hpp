@@ -0,0 +1,61 @@
+#ifndef _AUTO_TUNE_H_
+#define _AUTO_TUNE_H_
+
+#include "PID.hpp"
+
+/*
+ * 继电反馈自整定：用幅值为d的继电器(带回差h)代替PID闭环，使反馈在设定值附近等幅振荡，
+ * 测出振荡幅值a和周期Tu，临界增益 Ku = 4d / (pi * sqrt(a^2 - h^2))
+ * 第一个振荡周期是过渡过程，不参与统计；每步只有比较和累加，可以放在控制周期里运行
+ */
+enum AutoTuneRule {
+  kAutoTuneZieglerNichols = 0,   // 经典Z-N，响应快，超调大
+  kAutoTuneZieglerNicholsPI,     // Z-N的PI形式，适合速度环
+  kAutoTuneTyreusLuyben,         // 更保守，超调小，鲁棒性好
+};
+
+enum AutoTuneState {
+  kAutoTuneIdle = 0,
+  kAutoTuneRunning,
+  kAutoTuneDone,
+  kAutoTuneFailed,   // 超时仍未得到稳定的振荡
+};
+
+struct AutoTuneConfig {
+  float setpoint;     // 振荡中心
+  float bias;         // 继电器输出中心，克服静摩擦或重力时使用
+  float amplitude;    // 继电器输出幅值d
+  float hysteresis;   // 回差h，应大于反馈噪声
+  uint8_t cycles;     // 参与平均的振荡周期数
+  float timeout;      // 超时(s)
+};
+
+class AutoTune {
+  public:
+    AutoTune() { state_ = kAutoTuneIdle; ku_ = tu_ = 0; };
+    ~AutoTune() = default;
+    void start(const AutoTuneConfig &config);
+    void stop(void){ state_ = kAutoTuneIdle; };
+    float step(const float fdb, const float T);
+    bool result(PidParams *params, AutoTuneRule rule);
+    AutoTuneState state(void){ return state_; };
+    bool running(void){ return state_ == kAutoTuneRunning; };
+    float ku(void){ return ku_; };
+    float tu(void){ return tu_; };
+  private:
+    AutoTuneConfig config_;
+    AutoTuneState state_;
+    bool high_;           /*继电器当前输出为bias + d*/
+    float time_;          /*开始后的时间*/
+    float last_rise_;     /*上一次切到高输出的时刻*/
+    float peak_max_;      /*本周期反馈的最大、最小值*/
+    float peak_min_;
+    uint8_t rises_;       /*切到高输出的次数*/
+    float period_sum_;
+    float amp_sum_;
+    uint8_t samples_;
+    float ku_;
+    float tu_;
+};
+
+#endif
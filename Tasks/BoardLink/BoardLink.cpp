@@ -0,0 +1,186 @@
+#include "BoardLink.hpp"
+
+#include <string.h>
+
+void BoardLinkTx::init(const BoardLinkField *fields, uint8_t count, uint16_t key_interval)
+{
+  fields_ = fields;
+  count_ = BoardLink_Fits(fields, count) ? count : 0;   /*整张表不可用，不只同步其中一部分*/
+  mask_bytes_ = (count_ + 7) / 8;
+  key_interval_ = key_interval;
+  since_key_ = key_interval;     /*第一条消息总是关键帧*/
+  seq_ = 0;
+  key_ = false;
+  msg_len_ = frag_idx_ = frag_count_ = 0;
+  messages_ = frames_ = busy_ = 0;
+  memset(shadow_, 0, sizeof(shadow_));
+}
+
+/**
+ * @brief   比较字段与上次发出的值，生成一条新消息
+ * @retval  生成了需要发送的消息返回true
+ * @note    上一条消息的分片还没有全部取走时不生成新消息
+ */
+bool BoardLinkTx::update(void)
+{
+  if (count_ == 0)
+    return false;
+  if (frag_idx_ < frag_count_) {
+    busy_++;
+    return false;
+  }
+
+  key_ = (++since_key_ >= key_interval_);
+  uint32_t mask = 0;
+  uint8_t len = mask_bytes_;
+  uint8_t offset = 0;
+  for (uint8_t i = 0; i < count_; i++) {
+    const BoardLinkField &f = fields_[i];
+    if (key_ || memcmp(f.data, &shadow_[offset], f.size) != 0) {
+      memcpy(&shadow_[offset], f.data, f.size);
+      memcpy(&msg_[len], f.data, f.size);
+      len += f.size;
+      mask |= 1u << i;
+    }
+    offset += f.size;
+  }
+  if (mask == 0)          /*没有变化，不占用总线*/
+    return false;
+
+  for (uint8_t i = 0; i < mask_bytes_; i++)
+    msg_[i] = (mask >> (8 * i)) & 0xFF;
+  if (key_)
+    since_key_ = 0;
+
+  msg_len_ = len;
+  frag_idx_ = 0;
+  frag_count_ = (len + kBoardLinkFragPayload - 1) / kBoardLinkFragPayload;
+  seq_++;
+  messages_++;
+  return true;
+}
+
+/**
+ * @brief   取出当前消息的下一个分片，不移动分片位置
+ * @param   data为8字节帧缓冲
+ * @param   len返回DLC
+ * @retval  没有待发分片时返回false
+ */
+bool BoardLinkTx::peekFrame(uint8_t *data, uint8_t *len)
+{
+  if (frag_idx_ >= frag_count_)
+    return false;
+
+  uint8_t offset = frag_idx_ * kBoardLinkFragPayload;
+  uint8_t size = msg_len_ - offset;
+  if (size > kBoardLinkFragPayload)
+    size = kBoardLinkFragPayload;
+
+  data[0] = seq_;
+  data[1] = (key_ ? 0x80 : 0x00) | (frag_idx_ << 4) | (frag_count_ - 1);
+  memcpy(&data[2], &msg_[offset], size);
+  *len = size + 2;
+  return true;
+}
+
+/*peekFrame取出的分片已经发出，移到下一个分片*/
+void BoardLinkTx::popFrame(void)
+{
+  if (frag_idx_ >= frag_count_)
+    return;
+  frag_idx_++;
+  frames_++;
+}
+
+void BoardLinkRx::init(const BoardLinkField *fields, uint8_t count)
+{
+  fields_ = fields;
+  count_ = BoardLink_Fits(fields, count) ? count : 0;
+  mask_bytes_ = (count_ + 7) / 8;
+  has_seq_ = synced_ = assembling_ = false;
+  last_seq_ = asm_seq_ = asm_next_ = msg_len_ = 0;
+  messages_ = lost_ = dropped_ = 0;
+}
+
+/**
+ * @brief   处理一帧，运行在CAN接收中断中
+ * @param   data为帧数据
+ * @param   len为DLC
+ * @retval  一条消息接收完整并已写回变量时返回true
+ */
+bool BoardLinkRx::onFrame(const uint8_t *data, uint8_t len)
+{
+  if (count_ == 0 || len < 3 || len > 8)
+    return false;
+
+  uint8_t seq = data[0];
+  bool key = (data[1] & 0x80) != 0;
+  uint8_t idx = (data[1] >> 4) & 0x07;
+  uint8_t last = data[1] & 0x07;
+
+  if (idx == 0) {
+    if (assembling_)      /*上一条消息缺少后续分片*/
+      dropped_++;
+    assembling_ = true;
+    asm_seq_ = seq;
+    asm_next_ = 0;
+    msg_len_ = 0;
+  } else if (!assembling_ || seq != asm_seq_ || idx != asm_next_) {
+    if (assembling_)
+      dropped_++;
+    assembling_ = false;
+    return false;
+  }
+
+  memcpy(&msg_[msg_len_], &data[2], len - 2);
+  msg_len_ += len - 2;
+  asm_next_++;
+  if (idx != last)
+    return false;
+  assembling_ = false;
+
+  if (has_seq_ && seq != static_cast<uint8_t>(last_seq_ + 1)) {
+    lost_ += static_cast<uint8_t>(seq - last_seq_ - 1);
+    synced_ = false;
+  }
+  has_seq_ = true;
+  last_seq_ = seq;
+
+  if (!apply(key)) {
+    dropped_++;
+    synced_ = false;
+    return false;
+  }
+  if (key)
+    synced_ = true;
+  messages_++;
+  return true;
+}
+
+/*按掩码把值写回变量，长度与掩码不符时整条丢弃*/
+bool BoardLinkRx::apply(bool key)
+{
+  if (msg_len_ < mask_bytes_)
+    return false;
+
+  uint32_t mask = 0;
+  for (uint8_t i = 0; i < mask_bytes_; i++)
+    mask |= static_cast<uint32_t>(msg_[i]) << (8 * i);
+
+  uint8_t expect = mask_bytes_;
+  for (uint8_t i = 0; i < count_; i++) {
+    if (mask & (1u << i))
+      expect += fields_[i].size;
+  }
+  if (expect != msg_len_ || (key && mask != (1u << count_) - 1))
+    return false;
+
+  uint8_t offset = mask_bytes_;
+  for (uint8_t i = 0; i < count_; i++) {
+    if (mask & (1u << i)) {
+      memcpy(fields_[i].data, &msg_[offset], fields_[i].size);
+      offset += fields_[i].size;
+    }
+  }
+  return true;
+}
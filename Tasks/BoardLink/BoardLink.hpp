@@ -0,0 +1,118 @@
+#ifndef _BOARD_LINK_H_
+#define _BOARD_LINK_H_
+
+#include <stdint.h>
+
+/*
+ * 板间状态同步协议，不依赖HAL，可以在主机上回环测试
+ * 每条消息 = 变化字段掩码 + 变化字段的值，按6字节切成最多8帧：
+ *   byte0     消息序号
+ *   byte1     bit7关键帧标志，bit6~4分片序号，bit2~0最后一片的序号
+ *   byte2~7   数据，最后一片按实际长度设置DLC
+ * 字段没有变化时不发送任何帧；每key_interval条消息强制发送一次全部字段，
+ * 接收端通过序号检测丢包，丢包后直到下一个关键帧之前状态标记为未同步
+ * 字段表用数组传入，收发两端都由数组长度得到字段数；全部字段放不进一条消息的表用
+ * static_assert(BoardLink_Fits(...))在编译期拒绝，运行时传入这样的表ok()为false，收发都不工作
+ */
+#ifndef BOARD_LINK_RX_ID
+#define BOARD_LINK_RX_ID 0x321   /*对端板发送、本板接收的ID*/
+#endif
+#ifndef BOARD_LINK_TX_ID
+#define BOARD_LINK_TX_ID 0x322   /*本板发送的ID，对端板的收发ID与此相反*/
+#endif
+
+#define BOARD_LINK_FIELD(var) { &(var), sizeof(var) }
+
+static const uint8_t kBoardLinkMaxFields = 16;
+static const uint8_t kBoardLinkMaxFrags = 8;
+static const uint8_t kBoardLinkFragPayload = 6;
+static const uint8_t kBoardLinkMaxMsg = kBoardLinkMaxFrags * kBoardLinkFragPayload;
+
+struct BoardLinkField {
+  void *data;
+  uint8_t size;
+};
+
+/*全量消息(掩码 + 全部字段)的字节数*/
+constexpr uint16_t BoardLink_MsgSize(const BoardLinkField *fields, uint8_t count)
+{
+  uint16_t total = (count + 7) / 8;
+  for (uint8_t i = 0; i < count; i++)
+    total += fields[i].size;
+  return total;
+}
+
+/*字段表能否用于同步：字段数不超过kBoardLinkMaxFields，全量消息不超过kBoardLinkMaxMsg*/
+constexpr bool BoardLink_Fits(const BoardLinkField *fields, uint8_t count)
+{
+  return count <= kBoardLinkMaxFields && BoardLink_MsgSize(fields, count) <= kBoardLinkMaxMsg;
+}
+
+/*
+ * 发送端：记录上次发出的值，只打包变化的字段
+ * peekFrame取出当前分片，确认已经放进发送邮箱后再popFrame，发送失败时下次重发同一分片
+ */
+class BoardLinkTx {
+  public:
+    template <uint8_t N>
+    BoardLinkTx(const BoardLinkField (&fields)[N], uint16_t key_interval) { init(fields, N, key_interval); };
+    ~BoardLinkTx() = default;
+    bool ok(void){ return count_ != 0; };
+    bool update(void);
+    bool peekFrame(uint8_t *data, uint8_t *len);
+    void popFrame(void);
+    bool keyDue(void){ return since_key_ + 1 >= key_interval_; };   /*下一条消息是否为关键帧*/
+    uint32_t messages(void){ return messages_; };
+    uint32_t frames(void){ return frames_; };
+    uint32_t busy(void){ return busy_; };
+  private:
+    void init(const BoardLinkField *fields, uint8_t count, uint16_t key_interval);
+    const BoardLinkField *fields_;
+    uint8_t count_;     /*字段表放不进一条消息时为0*/
+    uint8_t mask_bytes_;
+    uint16_t key_interval_;
+    uint16_t since_key_;
+    uint8_t seq_;
+    bool key_;
+    uint8_t shadow_[kBoardLinkMaxMsg];
+    uint8_t msg_[kBoardLinkMaxMsg];
+    uint8_t msg_len_;
+    uint8_t frag_idx_;
+    uint8_t frag_count_;
+    uint32_t messages_;
+    uint32_t frames_;
+    uint32_t busy_;     /*上一条消息还没发完，跳过本次更新的次数*/
+};
+
+/*接收端：重组分片，把变化的字段写回对应变量*/
+class BoardLinkRx {
+  public:
+    template <uint8_t N>
+    BoardLinkRx(const BoardLinkField (&fields)[N]) { init(fields, N); };
+    ~BoardLinkRx() = default;
+    bool ok(void){ return count_ != 0; };
+    bool onFrame(const uint8_t *data, uint8_t len);
+    bool synced(void){ return synced_; };
+    uint32_t messages(void){ return messages_; };
+    uint32_t lost(void){ return lost_; };
+    uint32_t dropped(void){ return dropped_; };
+  private:
+    void init(const BoardLinkField *fields, uint8_t count);
+    bool apply(bool key);
+    const BoardLinkField *fields_;
+    uint8_t count_;     /*字段表放不进一条消息时为0*/
+    uint8_t mask_bytes_;
+    bool has_seq_;
+    bool synced_;
+    uint8_t last_seq_;
+    bool assembling_;
+    uint8_t asm_seq_;
+    uint8_t asm_next_;
+    uint8_t msg_[kBoardLinkMaxMsg];
+    uint8_t msg_len_;
+    uint32_t messages_;
+    uint32_t lost_;      /*序号不连续推算出的丢失消息数*/
+    uint32_t dropped_;   /*分片缺失或格式错误丢弃的消息数*/
+};
+
+#endif
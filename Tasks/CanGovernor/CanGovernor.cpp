@@ -0,0 +1,121 @@
+#include "CanGovernor.hpp"
+
+CanGovernor::CanGovernor(const CanGovernorConfig &config)
+{
+  config_ = config;
+  for (uint8_t i = 0; i < kCanClassNum; i++) {
+    policy_[i] = {kCanThrottleRate, 0, 0, 0xFF};
+    stats_[i] = {0, 0, 0};
+    last_sent_[i] = 0;
+  }
+  bits_.store(0, std::memory_order_relaxed);
+  arb_loss_.store(0, std::memory_order_relaxed);
+  arb_loss_last_ = 0;
+  window_start_ = 0;
+  load_ = peak_load_ = 0;
+  level_ = 0;
+}
+
+void CanGovernor::setPolicy(CanFrameClass cls, const CanClassPolicy &policy)
+{
+  policy_[cls] = policy;
+  stats_[cls].period = policy.period;
+}
+
+/**
+ * @brief   统计总线上的一帧（本板发送和接收到的都要统计）
+ * @param   dlc为数据长度
+ * @note    标准帧按最坏位填充估算：固定47位 + 数据位 + 填充位
+ */
+void CanGovernor::countFrame(uint8_t dlc)
+{
+  uint32_t payload = 8u * dlc;
+  bits_.fetch_add(47 + payload + (34 + payload - 1) / 4, std::memory_order_relaxed);
+}
+
+/**
+ * @brief   统计仲裁失败
+ * @param   count为因仲裁失败而结束的发送请求数
+ * @note    自动重发时，仲裁失败后重发成功的请求只留下TXOK，硬件不提供这部分次数，
+ *          所以这里只是下限，只能反映总线繁忙到请求被放弃的程度
+ */
+void CanGovernor::countArbitrationLoss(uint32_t count)
+{
+  arb_loss_.fetch_add(count, std::memory_order_relaxed);
+}
+
+/**
+ * @brief   窗口结束时计算负载并调整限流等级，每次升降一级
+ * @param   now为当前时间(ms)
+ */
+void CanGovernor::update(uint32_t now)
+{
+  uint32_t elapsed = now - window_start_;
+  if (elapsed < config_.window)
+    return;
+
+  uint32_t bits = bits_.exchange(0, std::memory_order_relaxed);
+  arb_loss_last_ = arb_loss_.exchange(0, std::memory_order_relaxed);
+  window_start_ = now;
+
+  uint32_t capacity = config_.bitrate / 1000 * elapsed;
+  load_ = static_cast<uint16_t>(static_cast<uint64_t>(bits) * 1000 / capacity);
+  if (load_ > peak_load_)
+    peak_load_ = load_;
+
+  if ((load_ > config_.high_permille || arb_loss_last_ > config_.arb_loss_high) &&
+      level_ < config_.max_level)
+    level_++;
+  else if (load_ < config_.low_permille && arb_loss_last_ <= config_.arb_loss_high / 2 &&
+           level_ > 0)
+    level_--;
+
+  for (uint8_t i = 0; i < kCanClassNum; i++)
+    stats_[i].period = period(static_cast<CanFrameClass>(i));
+}
+
+uint16_t CanGovernor::period(CanFrameClass cls)
+{
+  const CanClassPolicy &p = policy_[cls];
+  if (p.policy != kCanThrottleRate)
+    return p.period;
+
+  uint32_t t = static_cast<uint32_t>(p.period) << level_;
+  return (t > p.max_period) ? p.max_period : t;
+}
+
+/**
+ * @brief   判断某类帧此刻能否发送
+ * @param   cls为帧类别
+ * @param   now为当前时间(ms)
+ * @param   is_delta为true表示增量帧，丢掉后可由之后的帧补上
+ * @retval  放行返回true，占用这一个发送周期
+ * @note    放行后调用方不一定有数据要发，真正排队发送时再调用charge记一次发送
+ */
+bool CanGovernor::admit(CanFrameClass cls, uint32_t now, bool is_delta)
+{
+  CanClassStats &s = stats_[cls];
+  if (cls == kCanClassControl)
+    return true;
+
+  uint32_t since = now - last_sent_[cls];
+  if (since < s.period)
+    return false;
+
+  const uint16_t nominal = policy_[cls].period;
+  if (s.sent > 0 && nominal > 0)   /*按正常周期本该发送却被跳过的次数*/
+    s.throttled += since / nominal - 1;
+  last_sent_[cls] = now;
+  if (is_delta && policy_[cls].policy == kCanThrottleSkipDelta &&
+      level_ >= policy_[cls].shed_level) {
+    s.throttled++;
+    return false;
+  }
+  return true;
+}
+
+/*admit放行后确实排队发送了数据，记一次发送*/
+void CanGovernor::charge(CanFrameClass cls)
+{
+  stats_[cls].sent++;
+}
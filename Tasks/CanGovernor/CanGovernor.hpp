@@ -0,0 +1,79 @@
+#ifndef _CAN_GOVERNOR_H_
+#define _CAN_GOVERNOR_H_
+
+#include <stdint.h>
+#include <atomic>
+
+/*
+ * CAN带宽调节：按窗口统计总线负载和仲裁失败次数，
+ * 负载升高时逐级降低非关键周期帧的发送频率或跳过增量帧，
+ * 控制帧永远放行，不受调节等级影响。不依赖HAL，可以在主机上测试
+ * countFrame、countArbitrationLoss在CAN中断中调用，update在后台任务中取走并清零计数，
+ * 计数用原子操作，两边互相打断也不会丢失或重复计数；其余接口只在同一个上下文中调用
+ */
+enum CanFrameClass {
+  kCanClassControl = 0,   // 电机控制帧，永远放行
+  kCanClassBoardLink,     // 板间同步
+  kCanClassDebug,         // 调试数据
+  kCanClassSensor,        // 传感器数据
+  kCanClassNum,
+};
+
+enum CanThrottlePolicy {
+  kCanThrottleRate = 0,   // 每升一级发送周期加倍，不超过max_period
+  kCanThrottleSkipDelta,  // 达到shed_level后只放行关键帧，周期不变
+};
+
+struct CanClassPolicy {
+  CanThrottlePolicy policy;
+  uint16_t period;        // 正常发送周期(ms)
+  uint16_t max_period;    // 限流后的最长周期(ms)
+  uint8_t shed_level;     // kCanThrottleSkipDelta开始跳过增量帧的等级
+};
+
+struct CanClassStats {
+  uint32_t sent;          // 放行后实际发送的次数，由charge累计
+  uint32_t throttled;     // 被限流的次数
+  uint16_t period;        // 当前生效的周期(ms)
+};
+
+struct CanGovernorConfig {
+  uint32_t bitrate;       // 波特率(bit/s)
+  uint16_t window;        // 统计窗口(ms)
+  uint16_t high_permille; // 负载高于此值升一级
+  uint16_t low_permille;  // 负载低于此值降一级
+  uint16_t arb_loss_high; // 一个窗口内仲裁失败超过此值也升一级
+  uint8_t max_level;
+};
+
+class CanGovernor {
+  public:
+    CanGovernor(const CanGovernorConfig &config);
+    ~CanGovernor() = default;
+    void setPolicy(CanFrameClass cls, const CanClassPolicy &policy);
+    void countFrame(uint8_t dlc);
+    void countArbitrationLoss(uint32_t count);
+    void update(uint32_t now);
+    bool admit(CanFrameClass cls, uint32_t now, bool is_delta);
+    void charge(CanFrameClass cls);
+    uint16_t load(void){ return load_; };           /*上一个窗口的负载(千分比)*/
+    uint16_t peakLoad(void){ return peak_load_; };
+    uint32_t arbitrationLoss(void){ return arb_loss_last_; };
+    uint8_t level(void){ return level_; };
+    const CanClassStats &stats(CanFrameClass cls){ return stats_[cls]; };
+  private:
+    uint16_t period(CanFrameClass cls);
+    CanGovernorConfig config_;
+    CanClassPolicy policy_[kCanClassNum];
+    CanClassStats stats_[kCanClassNum];
+    uint32_t last_sent_[kCanClassNum];
+    std::atomic<uint32_t> bits_;
+    std::atomic<uint32_t> arb_loss_;
+    uint32_t arb_loss_last_;
+    uint32_t window_start_;
+    uint16_t load_;
+    uint16_t peak_load_;
+    uint8_t level_;
+};
+
+#endif
@@ -0,0 +1,53 @@
+#include "CanStamp.hpp"
+
+void CanRxStamper::reset(void)
+{
+  phase_valid_ = false;
+  phase_ = 0;
+  latency_ = 0;
+}
+
+/**
+ * @brief   只用中断时刻作为接收时间
+ * @param   isr_time为进入接收中断时的64位应用时间
+ * @retval  64位应用时间（CPU周期）
+ */
+uint64_t CanRxStamper::stamp(uint64_t isr_time)
+{
+  latency_ = 0;
+  return isr_time;
+}
+
+/**
+ * @brief   用TTCM硬件时间戳修正中断延迟
+ * @param   isr_time为进入接收中断时的64位应用时间
+ * @param   hw_stamp为接收邮箱中的16位时间戳（单位为CAN位时间）
+ * @retval  64位应用时间（CPU周期）
+ * @note    只要中断延迟小于计数器周期的一半（1Mbps下约32ms）换算就是正确的
+ */
+uint64_t CanRxStamper::stamp(uint64_t isr_time, uint16_t hw_stamp)
+{
+  int64_t isr = static_cast<int64_t>(isr_time);
+  int64_t wrap = static_cast<int64_t>(cycles_per_bit_) << 16;
+  int64_t candidate = isr - static_cast<int64_t>(hw_stamp) * cycles_per_bit_;
+
+  if (!phase_valid_) {
+    phase_ = candidate;
+    phase_valid_ = true;
+  }
+  if (candidate - phase_ >= wrap)   /*把相位推进到当前计数周期，总线静默再久也只做一次除法*/
+    phase_ += (candidate - phase_) / wrap * wrap;
+
+  int64_t delay = candidate - phase_;
+  if (delay > wrap / 2)
+    delay -= wrap;
+  else if (delay <= -wrap / 2)
+    delay += wrap;
+  if (delay < 0) {     /*比已知最小延迟还早，说明相位估计偏晚，修正相位*/
+    phase_ += delay;
+    delay = 0;
+  }
+
+  latency_ = static_cast<uint32_t>(delay);
+  return static_cast<uint64_t>(isr - delay);
+}
@@ -0,0 +1,37 @@
+#ifndef _CAN_STAMP_H_
+#define _CAN_STAMP_H_
+
+#include <stdint.h>
+
+/*
+ * CAN接收时间戳换算，不依赖HAL，可以在主机上测试
+ * 应用时间基准为64位CPU周期数（Clock_Extend由32位DWT CYCCNT扩展得到）
+ * 开启bxCAN时间触发模式(TTCM)后，用16位硬件时间戳修正中断延迟：
+ * CAN计数器与CPU同源于同一晶振，两者之间只差一个固定相位，
+ * 对每帧计算候选相位(中断时刻 - 硬件时间戳)，取最小值作为相位估计
+ * 硬件时间戳在SOF采样点锁存，中断在EOF之后才进入，所以最小值比真实相位晚一个常数：
+ * 已见过的最短一帧从SOF到EOF的时长加上最小的中断进入延迟(1Mbps下几十us)
+ * 换算结果因此是"与最快那一帧同样延迟时的中断时刻"，帧与帧之间的间隔是准确的，
+ * 需要绝对的SOF时刻时再减去按帧长标定的常数；出现更短的帧时这个偏差会向下跳一次
+ */
+class CanRxStamper {
+  public:
+    CanRxStamper(uint32_t cycles_per_bit) { cycles_per_bit_ = cycles_per_bit; reset(); };
+    ~CanRxStamper() = default;
+    void reset(void);
+    uint64_t stamp(uint64_t isr_time);
+    uint64_t stamp(uint64_t isr_time, uint16_t hw_stamp);
+    uint32_t latency(void){ return latency_; };   /*最近一帧比最快一帧多出的延迟周期数*/
+  private:
+    uint32_t cycles_per_bit_;
+    bool phase_valid_;
+    int64_t phase_;         /*CAN计数器为0时对应的CPU时间*/
+    uint32_t latency_;
+};
+
+static inline uint64_t CanStamp_CyclesToUs(uint64_t cycles, uint32_t cycles_per_us)
+{
+  return cycles / cycles_per_us;
+}
+
+#endif
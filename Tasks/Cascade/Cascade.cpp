@@ -0,0 +1,61 @@
+#include "Cascade.hpp"
+
+/**
+ * @brief   从外到内添加一级
+ * @param   pid为本级控制器
+ * @param   divider为相对基础tick的分频数
+ * @param   out_limit为本级输出(含前馈)的限幅
+ * @retval  级数已满或分频比外环大时返回false
+ */
+bool Cascade::addStage(Pid *pid, uint16_t divider, float out_limit)
+{
+  if (count_ >= kCascadeMaxStages || divider == 0)
+    return false;
+  if (count_ > 0 && divider > stages_[count_ - 1].divider)
+    return false;
+
+  CascadeStage &s = stages_[count_++];
+  s.pid = pid;
+  s.divider = divider;
+  s.T = base_T_ * divider;
+  s.out_limit = out_limit;
+  s.ff = s.ref = s.fdb = s.out = 0;
+  s.runs = s.cycles = s.cycles_max = 0;
+  return true;
+}
+
+/**
+ * @brief   运行一个基础tick
+ * @param   tick为基础tick计数
+ * @param   ref为最外环的参考值
+ * @param   fdb为各级的反馈值，顺序与添加顺序相同
+ * @retval  最内环的输出
+ */
+float Cascade::step(uint32_t tick, float ref, const float *fdb)
+{
+  for (uint8_t i = 0; i < count_; i++) {
+    CascadeStage &s = stages_[i];
+    if (tick % s.divider != 0) {   // 不是本级的tick，保持输出，外环输出作为内环参考值传下去
+      ref = s.out;
+      continue;
+    }
+
+    uint32_t start = cycles_ ? cycles_() : 0;
+    s.ref = ref;
+    s.fdb = fdb[i];
+    float out = s.pid->pidCalc(ref, fdb[i], s.T) + s.ff;
+    if (out > s.out_limit)
+      out = s.out_limit;
+    else if (out < -s.out_limit)
+      out = -s.out_limit;
+    s.out = out;
+    s.runs++;
+    if (cycles_) {
+      s.cycles = cycles_() - start;
+      if (s.cycles > s.cycles_max)
+        s.cycles_max = s.cycles;
+    }
+    ref = out;
+  }
+  return ref;
+}
@@ -0,0 +1,43 @@
+#ifndef _CASCADE_H_
+#define _CASCADE_H_
+
+#include "PID.hpp"
+
+/*
+ * 多速率串级控制：外环在前、内环在后，上一级的输出(加上本级前馈)作为下一级的参考值
+ * 每级按divider分频运行，不运行的tick保持上一次的输出，内环分频不能大于外环
+ * 最后一级的前馈可以用来叠加电流前馈
+ */
+static const uint8_t kCascadeMaxStages = 3;
+
+struct CascadeStage {
+  Pid *pid;
+  uint16_t divider;     // 每divider个基础tick运行一次
+  float T;              // 本级采样周期
+  float out_limit;      // 加上前馈后的输出限幅，也就是下一级参考值的范围
+  float ff;             // 前馈
+  float ref;
+  float fdb;
+  float out;
+  uint32_t runs;
+  uint32_t cycles;      // 最近一次计算的耗时
+  uint32_t cycles_max;
+};
+
+class Cascade {
+  public:
+    Cascade(float base_T, uint32_t (*cycles)(void)) { base_T_ = base_T; cycles_ = cycles; count_ = 0; };
+    ~Cascade() = default;
+    bool addStage(Pid *pid, uint16_t divider, float out_limit);
+    void setFeedForward(uint8_t stage, float ff){ stages_[stage].ff = ff; };
+    float step(uint32_t tick, float ref, const float *fdb);
+    const CascadeStage &stage(uint8_t index){ return stages_[index]; };
+    uint8_t count(void){ return count_; };
+  private:
+    CascadeStage stages_[kCascadeMaxStages];
+    uint8_t count_;
+    float base_T_;
+    uint32_t (*cycles_)(void);   /*周期计数器，用于统计每级耗时，可为空*/
+};
+
+#endif
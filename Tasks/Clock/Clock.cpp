@@ -0,0 +1,85 @@
+#include "Clock.hpp"
+#include "Dwt.hpp"
+#include <atomic>
+
+struct ClockSnapshot {
+  uint64_t base;      // 快照时刻的64位时间
+  uint32_t cycles;    // 快照时刻的CYCCNT
+};
+
+static ClockSnapshot clock_snapshot[2];
+static std::atomic<uint32_t> clock_seq;   // 当前快照为clock_snapshot[clock_seq & 1]，只由Clock_Tick修改
+static uint32_t clock_cycles_per_us;
+
+/**
+ * @brief   初始化，需在Dwt_Init之后、TIM6中断启动之前调用
+ * @param   cpu_hz为CPU主频
+ * @retval  None
+ */
+void Clock_Init(uint32_t cpu_hz)
+{
+  clock_cycles_per_us = cpu_hz / 1000000;
+  clock_snapshot[0] = {0, Dwt_Cycles()};
+  clock_seq.store(0, std::memory_order_release);
+}
+
+/**
+ * @brief   记录一次新快照，在TIM6中断中每个tick调用一次
+ * @retval  None
+ * @note    只能有一个调用者
+ */
+void Clock_Tick(void)
+{
+  uint32_t seq = clock_seq.load(std::memory_order_relaxed);
+  const ClockSnapshot &cur = clock_snapshot[seq & 1];
+  ClockSnapshot &next = clock_snapshot[(seq + 1) & 1];
+  uint32_t cycles = Dwt_Cycles();
+  next.base = cur.base + (cycles - cur.cycles);
+  next.cycles = cycles;
+  clock_seq.store(seq + 1, std::memory_order_release);
+}
+
+/**
+ * @brief   读取当前时间
+ * @retval  64位时间(CPU周期)
+ * @note    可以在任何上下文中调用
+ */
+uint64_t Clock_Now(void)
+{
+  uint32_t seq;
+  uint64_t base;
+  uint32_t elapsed;
+  do {
+    seq = clock_seq.load(std::memory_order_acquire);
+    const ClockSnapshot &s = clock_snapshot[seq & 1];
+    base = s.base;
+    elapsed = Dwt_Cycles() - s.cycles;
+  } while (clock_seq.load(std::memory_order_acquire) != seq);   // 读的过程中被Clock_Tick打断过，重读
+  return base + elapsed;
+}
+
+/**
+ * @brief   把之前读到的CYCCNT换算成64位时间
+ * @param   cycles为CYCCNT，与当前快照相差不超过半个回绕周期(12.7s)，可以早于快照
+ * @retval  64位时间(CPU周期)
+ * @note    用于中断入口先读CYCCNT、稍后再换算的场合，可以在任何上下文中调用
+ */
+uint64_t Clock_Extend(uint32_t cycles)
+{
+  uint32_t seq;
+  uint64_t base;
+  int32_t offset;
+  do {
+    seq = clock_seq.load(std::memory_order_acquire);
+    const ClockSnapshot &s = clock_snapshot[seq & 1];
+    base = s.base;
+    offset = static_cast<int32_t>(cycles - s.cycles);
+  } while (clock_seq.load(std::memory_order_acquire) != seq);
+  return base + offset;
+}
+
+/*把CPU周期数换算成us*/
+uint64_t Clock_ToUs(uint64_t cycles)
+{
+  return cycles / clock_cycles_per_us;
+}
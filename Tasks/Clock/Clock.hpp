@@ -0,0 +1,20 @@
+#ifndef _CLOCK_H_
+#define _CLOCK_H_
+
+#include <stdint.h>
+
+/*
+ * 64位单调时钟，单位为CPU周期(168MHz下约6ns)，上电后约3400年回绕
+ * 由32位DWT CYCCNT扩展得到：TIM6中断每个tick调用Clock_Tick记录一次(64位时间, CYCCNT)快照，
+ * 读取时用快照加上CYCCNT与快照之间的差值；两次Clock_Tick之间只要不超过CYCCNT回绕周期(25.5s)就是正确的
+ * 快照有两份，Clock_Tick写不在用的那一份，写完再把序号加1切换过去(双缓冲的seqlock)，
+ * 读者发现序号变了就重读，任何优先级的中断都可以读，不需要关中断，也不会因为打断了写入方而一直重试
+ * 所有时间戳(CAN接收、控制周期、串口等)都应使用这个时间基准
+ */
+void Clock_Init(uint32_t cpu_hz);
+void Clock_Tick(void);
+uint64_t Clock_Now(void);
+uint64_t Clock_Extend(uint32_t cycles);
+uint64_t Clock_ToUs(uint64_t cycles);
+
+#endif
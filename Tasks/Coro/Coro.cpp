@@ -0,0 +1,159 @@
+#include "Coro.hpp"
+
+enum CoroWait : uint8_t {
+  kCoroWaitNone = 0,   // 可以运行
+  kCoroWaitDelay,
+  kCoroWaitFlag,
+  kCoroWaitCan,
+};
+
+struct CoroTaskSlot {
+  std::coroutine_handle<> handle;
+  CoroWait wait;
+  uint32_t wake;        // kCoroWaitDelay的唤醒时刻
+  CoFlag *flag;
+  uint32_t mask;
+  CoCanQueue *queue;
+};
+
+static CoroTaskSlot coro_tasks[kCoroMaxTasks];
+static CoroTaskSlot *coro_current;   // 正在运行的协程，awaiter在挂起时把等待条件写进去
+static uint32_t coro_now;
+
+/*帧池，每个槽位kCoroFrameSize字节*/
+alignas(8) static uint8_t coro_frames[kCoroMaxTasks][kCoroFrameSize];
+static uint32_t coro_frame_used;
+
+void *CoTask::promise_type::operator new(size_t size) noexcept
+{
+  if (size > kCoroFrameSize)
+    return nullptr;
+  for (uint8_t i = 0; i < kCoroMaxTasks; i++) {
+    if (!(coro_frame_used & (1u << i))) {
+      coro_frame_used |= 1u << i;
+      return coro_frames[i];
+    }
+  }
+  return nullptr;
+}
+
+void CoTask::promise_type::operator delete(void *ptr, size_t size) noexcept
+{
+  (void)size;
+  uint8_t i = (static_cast<uint8_t *>(ptr) - coro_frames[0]) / kCoroFrameSize;
+  coro_frame_used &= ~(1u << i);
+}
+
+void CoFlag::Awaiter::await_suspend(std::coroutine_handle<> h) noexcept
+{
+  (void)h;
+  coro_current->wait = kCoroWaitFlag;
+  coro_current->flag = flag;
+  coro_current->mask = mask;
+}
+
+void CoDelay::await_suspend(std::coroutine_handle<> h) noexcept
+{
+  (void)h;
+  coro_current->wait = kCoroWaitDelay;
+  coro_current->wake = coro_now + ticks;
+}
+
+void CoCanQueue::Awaiter::await_suspend(std::coroutine_handle<> h) noexcept
+{
+  (void)h;
+  coro_current->wait = kCoroWaitCan;
+  coro_current->queue = queue;
+}
+
+bool CoCanQueue::push(uint32_t id, const uint8_t *data, uint8_t len)
+{
+  uint8_t head = head_.load(std::memory_order_relaxed);
+  uint8_t next = (head + 1) % kCoroCanQueueLen;
+  if (next == tail_.load(std::memory_order_acquire)) {
+    dropped_++;
+    return false;
+  }
+  CoCanFrame &f = frames_[head];
+  f.id = id;
+  f.len = len > 8 ? 8 : len;
+  for (uint8_t i = 0; i < f.len; i++)
+    f.data[i] = data[i];
+  head_.store(next, std::memory_order_release);
+  return true;
+}
+
+bool CoCanQueue::pop(CoCanFrame *frame)
+{
+  uint8_t tail = tail_.load(std::memory_order_relaxed);
+  if (tail == head_.load(std::memory_order_acquire))
+    return false;
+  *frame = frames_[tail];
+  tail_.store((tail + 1) % kCoroCanQueueLen, std::memory_order_release);
+  return true;
+}
+
+/**
+ * @brief   把协程加入运行时，下一次Coro_Run时开始运行
+ * @param   task为协程函数的返回值
+ * @retval  帧分配失败或协程已满时返回false
+ */
+bool Coro_Spawn(CoTask task)
+{
+  if (!task.valid())
+    return false;
+  for (CoroTaskSlot &slot : coro_tasks) {
+    if (!slot.handle) {
+      slot.handle = task.release();
+      slot.wait = kCoroWaitNone;
+      return true;
+    }
+  }
+  return false;   // task析构时释放帧
+}
+
+static bool Coro_Ready(CoroTaskSlot &slot)
+{
+  switch (slot.wait) {
+    case kCoroWaitDelay:
+      return static_cast<int32_t>(coro_now - slot.wake) >= 0;
+    case kCoroWaitFlag:
+      return slot.flag->test(slot.mask);
+    case kCoroWaitCan:
+      return !slot.queue->empty();
+    case kCoroWaitNone:
+    default:
+      return true;
+  }
+}
+
+/**
+ * @brief   在主循环中调用，运行所有等待条件已满足的协程，每个最多运行到下一次co_await
+ * @param   now为当前tick
+ * @retval  None
+ */
+void Coro_Run(uint32_t now)
+{
+  coro_now = now;
+  for (CoroTaskSlot &slot : coro_tasks) {
+    if (!slot.handle || !Coro_Ready(slot))
+      continue;
+    slot.wait = kCoroWaitNone;
+    coro_current = &slot;
+    slot.handle.resume();
+    coro_current = nullptr;
+    if (slot.handle.done()) {
+      slot.handle.destroy();
+      slot.handle = nullptr;
+    }
+  }
+}
+
+uint8_t Coro_Count(void)
+{
+  uint8_t count = 0;
+  for (CoroTaskSlot &slot : coro_tasks)
+    if (slot.handle)
+      count++;
+  return count;
+}
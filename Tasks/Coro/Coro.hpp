@@ -0,0 +1,109 @@
+#ifndef _CORO_H_
+#define _CORO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <coroutine>
+#include <atomic>
+
+/*
+ * 不用堆的协程运行时，用于遥测、标定、参数处理等可以慢慢做的后台工作
+ * 协程帧从静态帧池分配，帧池满或帧太大时返回无效的CoTask，Coro_Spawn会返回false
+ * 协程可以co_await：
+ *   CoDelay(n)           等待n个tick
+ *   flag.wait(mask)      等待CoFlag中的任一位被置位，返回并清除这些位；DMA完成、外部事件都用它
+ *   queue.receive()      等待CoCanQueue中有CAN帧，返回这一帧
+ * CoFlag::set、CoCanQueue::push可以在中断中调用；Coro_Spawn、Coro_Run只能在主循环中调用
+ * Coro_Run依次检查每个协程等待的条件，满足就恢复运行，协程之间协作式切换
+ */
+static const uint8_t kCoroMaxTasks = 8;
+static const size_t kCoroFrameSize = 384;   // 单个协程帧的上限，局部大数组应放到静态区
+static const uint8_t kCoroCanQueueLen = 8;
+
+class CoTask {
+  public:
+    struct promise_type {
+      CoTask get_return_object() noexcept { return CoTask(std::coroutine_handle<promise_type>::from_promise(*this)); };
+      static CoTask get_return_object_on_allocation_failure() noexcept { return CoTask(); };
+      std::suspend_always initial_suspend() noexcept { return {}; };   // 由Coro_Run开始运行
+      std::suspend_always final_suspend() noexcept { return {}; };     // 由Coro_Run回收帧
+      void return_void() noexcept {};
+      void unhandled_exception() noexcept {};
+      static void *operator new(size_t size) noexcept;
+      static void operator delete(void *ptr, size_t size) noexcept;
+    };
+    CoTask() : handle_(nullptr) {};
+    CoTask(CoTask &&other) noexcept : handle_(other.handle_) { other.handle_ = nullptr; };
+    CoTask(const CoTask &) = delete;
+    CoTask &operator=(const CoTask &) = delete;
+    ~CoTask() { if (handle_) handle_.destroy(); };
+    bool valid(void){ return handle_ != nullptr; };
+    std::coroutine_handle<> release(void){ std::coroutine_handle<> h = handle_; handle_ = nullptr; return h; };
+  private:
+    explicit CoTask(std::coroutine_handle<promise_type> handle) : handle_(handle) {};
+    std::coroutine_handle<promise_type> handle_;
+};
+
+/*事件标志，最多32位*/
+class CoFlag {
+  public:
+    CoFlag() { bits_.store(0); };
+    ~CoFlag() = default;
+    void set(uint32_t bits){ bits_.fetch_or(bits); };
+    uint32_t take(uint32_t mask){ return bits_.fetch_and(~mask) & mask; };
+    bool test(uint32_t mask){ return (bits_.load() & mask) != 0; };
+
+    struct Awaiter {
+      CoFlag *flag;
+      uint32_t mask;
+      bool await_ready() noexcept { return flag->test(mask); };
+      void await_suspend(std::coroutine_handle<> h) noexcept;
+      uint32_t await_resume() noexcept { return flag->take(mask); };
+    };
+    Awaiter wait(uint32_t mask){ return {this, mask}; };
+  private:
+    std::atomic<uint32_t> bits_;
+};
+
+struct CoCanFrame {
+  uint32_t id;
+  uint8_t len;
+  uint8_t data[8];
+};
+
+/*单生产者(CAN接收中断)单消费者(一个协程)的CAN帧队列，满时丢弃新帧*/
+class CoCanQueue {
+  public:
+    CoCanQueue() { head_.store(0); tail_.store(0); dropped_ = 0; };
+    ~CoCanQueue() = default;
+    bool push(uint32_t id, const uint8_t *data, uint8_t len);
+    bool pop(CoCanFrame *frame);
+    bool empty(void){ return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire); };
+    uint32_t dropped(void){ return dropped_; };
+
+    struct Awaiter {
+      CoCanQueue *queue;
+      bool await_ready() noexcept { return !queue->empty(); };
+      void await_suspend(std::coroutine_handle<> h) noexcept;
+      CoCanFrame await_resume() noexcept { CoCanFrame f{}; queue->pop(&f); return f; };
+    };
+    Awaiter receive(void){ return {this}; };
+  private:
+    CoCanFrame frames_[kCoroCanQueueLen];
+    std::atomic<uint8_t> head_;   /*下一个写入位置，只由push修改*/
+    std::atomic<uint8_t> tail_;   /*下一个读出位置，只由pop修改*/
+    uint32_t dropped_;
+};
+
+struct CoDelay {
+  uint32_t ticks;
+  bool await_ready() noexcept { return ticks == 0; };
+  void await_suspend(std::coroutine_handle<> h) noexcept;
+  void await_resume() noexcept {};
+};
+
+bool Coro_Spawn(CoTask task);
+void Coro_Run(uint32_t now);
+uint8_t Coro_Count(void);
+
+#endif
@@ -0,0 +1,83 @@
+#include "CpuLoad.hpp"
+#include "Dwt.hpp"
+
+static uint32_t cpu_idle_cycles;     // 累计空闲周期，只在主循环中关中断修改
+static uint32_t cpu_last_idle;
+static uint32_t cpu_last_cycles;
+static uint32_t cpu_window_idle;
+static uint32_t cpu_window_cycles;
+static float cpu_window_peak;
+static uint16_t cpu_window;
+static uint16_t cpu_ticks;
+static CpuLoadStats cpu_stats;
+
+/**
+ * @brief   初始化，需在Dwt_Init之后调用
+ * @param   window为统计窗口的tick数，1ms tick时1000即每秒更新一次
+ * @retval  None
+ */
+void CpuLoad_Init(uint16_t window)
+{
+  cpu_window = window ? window : 1;
+  cpu_idle_cycles = cpu_last_idle = 0;
+  cpu_last_cycles = Dwt_Cycles();
+  cpu_window_idle = cpu_window_cycles = 0;
+  cpu_window_peak = 0;
+  cpu_ticks = 0;
+  cpu_stats = {0, 0, 0, 0};
+}
+
+/**
+ * @brief   休眠到下一个中断，记录休眠的周期数
+ * @retval  None
+ * @note    关中断后再WFI，有中断挂起时WFI返回但中断要等开中断后才执行，
+ *          这样统计到的只有休眠时间，不包括唤醒后中断服务的时间
+ */
+void CpuLoad_Idle(void)
+{
+  __disable_irq();
+  uint32_t start = Dwt_Cycles();
+  __DSB();
+  __WFI();
+  cpu_idle_cycles += Dwt_Cycles() - start;
+  __enable_irq();
+}
+
+/**
+ * @brief   每个tick调用一次，计算这个tick的占用率
+ * @retval  None
+ */
+void CpuLoad_Update(void)
+{
+  uint32_t now = Dwt_Cycles();
+  uint32_t cycles = now - cpu_last_cycles;
+  uint32_t idle = cpu_idle_cycles - cpu_last_idle;
+  cpu_last_cycles = now;
+  cpu_last_idle = cpu_idle_cycles;
+  if (cycles == 0)
+    return;
+  if (idle > cycles)   // 空闲在上一个tick开始，跨过了tick边界
+    idle = cycles;
+
+  float load = 100.0f * (cycles - idle) / cycles;
+  if (load > cpu_window_peak)
+    cpu_window_peak = load;
+  if (load > cpu_stats.peak_all)
+    cpu_stats.peak_all = load;
+  cpu_window_idle += idle;
+  cpu_window_cycles += cycles;
+
+  if (++cpu_ticks >= cpu_window) {
+    cpu_stats.load = 100.0f * (cpu_window_cycles - cpu_window_idle) / cpu_window_cycles;
+    cpu_stats.peak = cpu_window_peak;
+    cpu_stats.windows++;
+    cpu_window_idle = cpu_window_cycles = 0;
+    cpu_window_peak = 0;
+    cpu_ticks = 0;
+  }
+}
+
+const CpuLoadStats *CpuLoad_GetStats(void)
+{
+  return &cpu_stats;
+}
@@ -0,0 +1,24 @@
+#ifndef _CPU_LOAD_H_
+#define _CPU_LOAD_H_
+
+#include "main.h"
+
+/*
+ * 空闲时WFI休眠，用DWT周期计数统计空闲时间，得到CPU占用率
+ * CpuLoad_Idle在主循环中调用；CpuLoad_Update每个tick在TIM6中断中调用一次(调度器的ISR任务)
+ * 每个tick算一次占用率，window个tick汇总成平均值和这段时间内单个tick的峰值
+ * Dwt_Init置位了DBGMCU_CR_DBG_SLEEP，休眠期间HCLK保持运行，CYCCNT不停，空闲周期才能计准
+ */
+struct CpuLoadStats {
+  float load;           // 上一个统计窗口的平均占用率(%)
+  float peak;           // 上一个统计窗口内单个tick的最高占用率(%)
+  float peak_all;       // 上电以来单个tick的最高占用率(%)
+  uint32_t windows;     // 已完成的统计窗口数
+};
+
+void CpuLoad_Init(uint16_t window);
+void CpuLoad_Idle(void);
+void CpuLoad_Update(void);
+const CpuLoadStats *CpuLoad_GetStats(void);
+
+#endif
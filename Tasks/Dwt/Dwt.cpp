@@ -0,0 +1,9 @@
+#include "Dwt.hpp"
+
+void Dwt_Init(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;   /*使能DWT/ITM跟踪模块*/
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;              /*启动周期计数*/
+  DBGMCU->CR |= DBGMCU_CR_DBG_SLEEP;                /*休眠时HCLK不停，CYCCNT继续计数*/
+}
@@ -0,0 +1,14 @@
+#ifndef _DWT_H_
+#define _DWT_H_
+
+#include "main.h"
+
+void Dwt_Init(void);
+
+/*读取DWT周期计数器，168MHz下约25.5s回绕一次*/
+static inline uint32_t Dwt_Cycles(void)
+{
+  return DWT->CYCCNT;
+}
+
+#endif
@@ -0,0 +1,36 @@
+#include "FeedbackSync.hpp"
+
+/**
+ * @brief   记录一帧反馈
+ * @param   index为电机在组掩码中的位序号
+ * @param   now为当前tick
+ * @retval  组内反馈到齐返回true，调用者应立即执行控制
+ */
+bool FeedbackSync::feedback(uint8_t index, uint32_t now)
+{
+  pending_mask_ |= (1u << index) & group_mask_;
+  if (pending_mask_ != group_mask_)
+    return false;
+
+  pending_mask_ = 0;
+  last_run_ = now;
+  sync_runs_++;
+  return true;
+}
+
+/**
+ * @brief   检查反馈是否超时
+ * @param   now为当前tick
+ * @retval  超过timeout个tick没有执行控制返回true，调用者按定时器调度执行一次
+ * @note    超时后丢弃未到齐的反馈，避免用新旧混合的数据触发下一次控制
+ */
+bool FeedbackSync::poll(uint32_t now)
+{
+  if (now - last_run_ < timeout_)
+    return false;
+
+  pending_mask_ = 0;
+  last_run_ = now;
+  fallback_runs_++;
+  return true;
+}
@@ -0,0 +1,31 @@
+#ifndef _FEEDBACK_SYNC_H_
+#define _FEEDBACK_SYNC_H_
+
+#include <stdint.h>
+
+/*
+ * 反馈同步触发：一组电机的反馈帧到齐后立即执行该组的控制，
+ * 反馈缺失超过timeout个tick时退回定时器调度，保证控制不中断
+ * feedback()在CAN接收中断中调用，poll()在定时器中断中调用，
+ * 调用poll()时需要屏蔽CAN接收中断
+ */
+class FeedbackSync {
+  public:
+    FeedbackSync(uint32_t group_mask, uint32_t timeout) { group_mask_ = group_mask; timeout_ = timeout;
+                                                          pending_mask_ = last_run_ = 0;
+                                                          sync_runs_ = fallback_runs_ = 0; };
+    ~FeedbackSync() = default;
+    bool feedback(uint8_t index, uint32_t now);
+    bool poll(uint32_t now);
+    uint32_t syncRuns(void){ return sync_runs_; };
+    uint32_t fallbackRuns(void){ return fallback_runs_; };
+  private:
+    uint32_t group_mask_;     /*组内电机对应的位*/
+    uint32_t pending_mask_;   /*本周期已到达的反馈*/
+    uint32_t timeout_;
+    uint32_t last_run_;
+    uint32_t sync_runs_;
+    uint32_t fallback_runs_;
+};
+
+#endif
@@ -0,0 +1,81 @@
+#include "FuzzyPid.hpp"
+
+static constexpr FuzzySurface kFuzzyKp = FuzzyBuildSurface(FuzzyRules::kKp);
+static constexpr FuzzySurface kFuzzyKi = FuzzyBuildSurface(FuzzyRules::kKi);
+static constexpr FuzzySurface kFuzzyKd = FuzzyBuildSurface(FuzzyRules::kKd);
+
+/*把归一化输入映射到网格坐标，返回格子下标，frac为格内位置*/
+static inline uint8_t FuzzyCell(float x, float *frac)
+{
+  float g = (x + 3) * kFuzzyGridPerTerm;
+  if (g <= 0) {
+    *frac = 0;
+    return 0;
+  }
+  if (g >= kFuzzyGrid - 1) {
+    *frac = 1;
+    return kFuzzyGrid - 2;
+  }
+  uint8_t i = static_cast<uint8_t>(g);
+  *frac = g - i;
+  return i;
+}
+
+static inline float FuzzyLookup(const FuzzySurface &s, uint8_t i, uint8_t j, float fi, float fj)
+{
+  float v0 = s.v[i][j] + fj * (s.v[i][j + 1] - s.v[i][j]);
+  float v1 = s.v[i + 1][j] + fj * (s.v[i + 1][j + 1] - s.v[i + 1][j]);
+  return v0 + fi * (v1 - v0);
+}
+
+/**
+ * @brief   以Pid当前的增益作为基准增益
+ * @param   pid为被调整的控制器
+ * @param   config为归一化和调整量
+ */
+FuzzyPid::FuzzyPid(Pid &pid, const FuzzyPidConfig &config) : pid_(pid)
+{
+  config_ = config;
+  inv_e_scale_ = 3.0f / config.e_scale;
+  inv_ec_scale_ = 3.0f / config.ec_scale;
+  T_ = 0;
+  ec_gain_ = 0;
+  PidParams params = pid.getParams();
+  setBase(params.kp, params.ki, params.kd);
+  last_error_ = 0;
+  started_ = false;
+  dkp_ = dki_ = dkd_ = 0;
+}
+
+/**
+ * @brief   查表调整增益后计算一次PID
+ * @param   ref、fdb、T同Pid::pidCalc
+ * @retval  PID输出
+ */
+float FuzzyPid::pidCalc(const float ref, const float fdb, const float T)
+{
+  float error = ref - fdb;
+  if (!started_) {   // 第一拍没有上一次的误差，视为ec为0，不产生虚假的大变化率
+    started_ = true;
+    last_error_ = error;
+  }
+  if (T != T_) {      // 与Pid相同，只在采样周期变化时做除法
+    T_ = T;
+    ec_gain_ = inv_ec_scale_ / T;
+  }
+  float ec = (error - last_error_) * ec_gain_;   // 已归一化
+  last_error_ = error;
+
+  float fi, fj;
+  uint8_t i = FuzzyCell(error * inv_e_scale_, &fi);
+  uint8_t j = FuzzyCell(ec, &fj);
+  dkp_ = FuzzyLookup(kFuzzyKp, i, j, fi, fj);
+  dki_ = FuzzyLookup(kFuzzyKi, i, j, fi, fj);
+  dkd_ = FuzzyLookup(kFuzzyKd, i, j, fi, fj);
+
+  float kp = kp0_ + config_.dkp * dkp_;
+  float ki = ki0_ + config_.dki * dki_;
+  float kd = kd0_ + config_.dkd * dkd_;
+  pid_.setGains(kp > 0 ? kp : 0, ki > 0 ? ki : 0, kd > 0 ? kd : 0);
+  return pid_.pidCalc(ref, fdb, T);
+}
@@ -0,0 +1,82 @@
+#ifndef _FUZZY_PID_H_
+#define _FUZZY_PID_H_
+
+#include "PID.hpp"
+#include "FuzzyRules.hpp"
+
+/*
+ * 模糊PID监督器：按误差e和误差变化率ec调整Pid的增益
+ * 模糊推理(三角隶属度、乘积推理、重心法)在编译期对规则库离线计算，得到每个增益一张网格表，
+ * 运行时只做一次双线性插值，然后 k = k0 + 系数 * Δk 通过Pid::setGains交给Pid计算
+ * e、ec按e_scale、ec_scale归一化到[-3, 3]，超出的取边界
+ */
+static constexpr uint8_t kFuzzyGridPerTerm = 2;                     // 相邻语言值之间的网格数
+static constexpr uint8_t kFuzzyGrid = 6 * kFuzzyGridPerTerm + 1;    // 每维网格点数
+static constexpr float kFuzzyWidth = 1.5f;                          // 三角隶属度函数的半宽
+
+struct FuzzySurface {
+  float v[kFuzzyGrid][kFuzzyGrid];   // 归一化到[-1, 1]
+};
+
+constexpr float FuzzyMembership(float d)
+{
+  float a = d < 0 ? -d : d;
+  return a < kFuzzyWidth ? 1.0f - a / kFuzzyWidth : 0.0f;
+}
+
+constexpr FuzzySurface FuzzyBuildSurface(const FuzzyTerm (&rules)[7][7])
+{
+  FuzzySurface s{};
+  for (int i = 0; i < kFuzzyGrid; i++) {
+    for (int j = 0; j < kFuzzyGrid; j++) {
+      float e = static_cast<float>(i) / kFuzzyGridPerTerm - 3;
+      float ec = static_cast<float>(j) / kFuzzyGridPerTerm - 3;
+      float num = 0, den = 0;
+      for (int a = 0; a < 7; a++) {
+        for (int b = 0; b < 7; b++) {
+          float w = FuzzyMembership(e - (a - 3)) * FuzzyMembership(ec - (b - 3));
+          num += w * static_cast<int8_t>(rules[a][b]);
+          den += w;
+        }
+      }
+      s.v[i][j] = num / den / 3;
+    }
+  }
+  return s;
+}
+
+struct FuzzyPidConfig {
+  float e_scale;    // 对应PB的误差
+  float ec_scale;   // 对应PB的误差变化率(单位/s)
+  float dkp;        // Δk为±1时增益的调整量
+  float dki;
+  float dkd;
+};
+
+class FuzzyPid {
+  public:
+    FuzzyPid(Pid &pid, const FuzzyPidConfig &config);
+    ~FuzzyPid() = default;
+    void setBase(float kp, float ki, float kd){ kp0_ = kp; ki0_ = ki; kd0_ = kd; };
+    float pidCalc(const float ref, const float fdb, const float T);
+    float dkp(void){ return dkp_; };   /*最近一次的归一化调整量*/
+    float dki(void){ return dki_; };
+    float dkd(void){ return dkd_; };
+  private:
+    Pid &pid_;
+    FuzzyPidConfig config_;
+    float inv_e_scale_;
+    float inv_ec_scale_;
+    float T_;           /*ec_gain_对应的采样周期*/
+    float ec_gain_;     /*3/(ec_scale*T)，误差之差乘它得到归一化的ec*/
+    float kp0_;
+    float ki0_;
+    float kd0_;
+    float last_error_;
+    bool started_;      /*已经有过一次误差，ec可以计算*/
+    float dkp_;
+    float dki_;
+    float dkd_;
+};
+
+#endif
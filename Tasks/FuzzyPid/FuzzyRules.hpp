@@ -0,0 +1,65 @@
+#ifndef _FUZZY_RULES_H_
+#define _FUZZY_RULES_H_
+
+#include <stdint.h>
+
+/*
+ * 模糊PID规则库：行为误差e，列为误差变化率ec，语言值NB~PB对应-3~3
+ * 修改规则后重新编译即可，查找表由FuzzyPid.hpp在编译期生成
+ * 语言值是有作用域的枚举，NB~PB这些短名字只在命名空间FuzzyRules内可以直接使用，不会泄漏给包含者
+ */
+enum class FuzzyTerm : int8_t { NB = -3, NM = -2, NS = -1, ZO = 0, PS = 1, PM = 2, PB = 3 };
+
+namespace FuzzyRules {
+using enum FuzzyTerm;
+
+/*|e|大时加大kp，误差还在增大(e与ec同号)时加得更多，误差已在减小时少加或减小*/
+static constexpr FuzzyTerm kKp[7][7] = {
+  /*        NB  NM  NS  ZO  PS  PM  PB    ec */
+  /*NB*/  { PB, PB, PB, PM, PM, PS, PS },
+  /*NM*/  { PB, PB, PM, PM, PS, ZO, ZO },
+  /*NS*/  { PM, PM, PS, PS, ZO, NS, NM },
+  /*ZO*/  { PS, PS, ZO, ZO, ZO, PS, PS },
+  /*PS*/  { NM, NS, ZO, PS, PS, PM, PM },
+  /*PM*/  { ZO, ZO, PS, PM, PM, PB, PB },
+  /*PB*/  { PS, PS, PM, PM, PB, PB, PB },
+};
+
+/*|e|大时减小ki防止积分饱和，接近稳态时加大ki消除静差*/
+static constexpr FuzzyTerm kKi[7][7] = {
+  /*NB*/  { NB, NB, NB, NM, NM, NS, NS },
+  /*NM*/  { NB, NM, NM, NS, NS, ZO, ZO },
+  /*NS*/  { NS, ZO, PS, PS, PM, PM, PM },
+  /*ZO*/  { PS, PM, PB, PB, PB, PM, PS },
+  /*PS*/  { PM, PM, PM, PS, PS, ZO, NS },
+  /*PM*/  { ZO, ZO, NS, NS, NM, NM, NB },
+  /*PB*/  { NS, NS, NM, NM, NB, NB, NB },
+};
+
+/*|e|小而|ec|大时加大kd抑制超调，|e|大时减小kd加快响应*/
+static constexpr FuzzyTerm kKd[7][7] = {
+  /*NB*/  { NS, NS, NM, NM, NM, NS, NS },
+  /*NM*/  { ZO, NS, NS, NM, NS, NS, ZO },
+  /*NS*/  { PS, ZO, ZO, NS, ZO, ZO, PS },
+  /*ZO*/  { PM, PS, ZO, ZO, ZO, PS, PM },
+  /*PS*/  { PS, ZO, ZO, NS, ZO, ZO, PS },
+  /*PM*/  { ZO, NS, NS, NM, NS, NS, ZO },
+  /*PB*/  { NS, NS, NM, NM, NM, NS, NS },
+};
+
+}  // namespace FuzzyRules
+
+/*规则对(e, ec)与(-e, -ec)对称，正反方向的调整相同*/
+constexpr bool FuzzyRulesSymmetric(const FuzzyTerm (&rules)[7][7])
+{
+  for (int a = 0; a < 7; a++)
+    for (int b = 0; b < 7; b++)
+      if (rules[a][b] != rules[6 - a][6 - b])
+        return false;
+  return true;
+}
+static_assert(FuzzyRulesSymmetric(FuzzyRules::kKp), "kp rules are not symmetric");
+static_assert(FuzzyRulesSymmetric(FuzzyRules::kKi), "ki rules are not symmetric");
+static_assert(FuzzyRulesSymmetric(FuzzyRules::kKd), "kd rules are not symmetric");
+
+#endif
@@ -1,17 +1,28 @@
 #include "main.h"
 #include "GM6020.hpp"
+#include "Topology.hpp"
 
-GM6020 motors[7] = {1, 2, 3, 4, 5, 6, 7};   /*定义全局变量motors，用来存放各个电机的状态*/
+#include <utility>
+
+template <size_t... I>
+static constexpr std::array<GM6020, sizeof...(I)> MakeMotors(std::index_sequence<I...>)
+{
+  return {GM6020(TopoMotor(I).motor_id, TopoMotor(I).tx_id, TopoMotor(I).rx_id, TopoMotor(I).slot)...};
+}
+
+/*定义全局变量motors，用来存放各个电机的状态，由拓扑在编译期生成*/
+constinit std::array<GM6020, kTopoMotorNum> motors =
+    MakeMotors(std::make_index_sequence<kTopoMotorNum>{});
 
 
 uint32_t GM6020::txId(void)
 {
-    return 0x1FE;   /*使用电流控制，表头为0x1FE*/
+    return tx_id_;   /*使用电流控制，id 1~4为0x1FE，5~7为0x2FE*/
 }
 
 uint32_t GM6020::rxId(void)
 {
-    return 0x204 + id_;   /*电机id设置为1*/
+    return rx_id_;
 }
 
 void GM6020::setInput(float current)
@@ -21,21 +32,30 @@ void GM6020::setInput(float current)
     input_ = 3;     /*电机最大转矩电流为3A*/
   else if (current < -3)
     input_ = -3;
-  
+  input_raw_ = static_cast<int16_t>(input_ * (16384.0f / 3.0f));
+}
+
+void GM6020::setInputRaw(int16_t command)
+{
+  if (command > 16384)
+    command = 16384;
+  else if (command < -16384)
+    command = -16384;
+  input_raw_ = command;
+  input_ = command * (3.0f / 16384.0f);
 }
 
 bool GM6020::encode(uint8_t *data) 
 {
-  /*电流范围: -3A ~ +3A → CAN数据: -16384 ~ +16384*/
-  int16_t current_can = static_cast<int16_t>(input_ * (16384.0f / 3.0f));
+  /*电流范围: -3A ~ +3A → CAN数据: -16384 ~ +16384，在setInput中换算*/
+  int16_t current_can = input_raw_;
     
   /*拆分数据*/
   uint8_t high_byte = (current_can >> 8) & 0xFF;
   uint8_t low_byte = current_can & 0xFF;
     
-  /*确定数组中的位置*/
-  int position = (id_ - 1) % 4;  
-  int byte_offset = position * 2;   
+  /*确定数组中的位置，槽位由拓扑给出，编译期已检查不越界、不冲突*/
+  int byte_offset = slot_ * 2;
     
   data[byte_offset] = high_byte;
   data[byte_offset + 1] = low_byte;
@@ -52,6 +72,7 @@ bool GM6020::decode(uint8_t *data)
     
   /*解码速度*/
   int16_t raw_vel = (data[2] << 8) | data[3];
+  raw_vel_ = raw_vel;
   vel_ = static_cast<float>(raw_vel);
     
   /*解码电流*/ 
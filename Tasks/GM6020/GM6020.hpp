@@ -8,24 +8,36 @@
 
 class GM6020 {
   public:
-    GM6020(uint32_t id) { id_ = id; };
+    constexpr GM6020(uint32_t id, uint32_t tx_id, uint32_t rx_id, uint8_t slot)
+        : id_(id), tx_id_(tx_id), rx_id_(rx_id), slot_(slot), input_(0), input_raw_(0), angle_(0), vel_(0),
+          raw_vel_(0), current_(0), temp_(0), rx_stamp_(0) {};
     ~GM6020() = default;
     uint32_t txId(void);
     uint32_t rxId(void);
     float angle(void){ return angle_; };
     float vel(void){ return vel_; };
+    int16_t rawVel(void){ return raw_vel_; };   /*反馈帧中的原始速度(rpm)，供定点控制器使用*/
     float current(void){ return current_; };
     float temp(void){ return temp_; };
+    uint64_t rxStamp(void){ return rx_stamp_; };   /*最近一帧反馈的接收时间，由CAN接收中断写入，其它上下文读取时需屏蔽CAN接收中断*/
+    void setRxStamp(uint64_t stamp){ rx_stamp_ = stamp; };
     void setInput(float current);
+    void setInputRaw(int16_t command);   /*直接给出CAN电流指令，-16384 ~ +16384*/
     bool encode(uint8_t *data);
     bool decode(uint8_t *data);
   private:
     uint32_t id_;
+    uint32_t tx_id_;
+    uint32_t rx_id_;
+    uint8_t slot_;      /*在控制帧中的槽位，来自拓扑*/
     float input_;
+    int16_t input_raw_;
     float angle_;
     float vel_;
+    int16_t raw_vel_;
     float current_;
     float temp_;
+    uint64_t rx_stamp_;
 };
 
 
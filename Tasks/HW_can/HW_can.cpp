@@ -16,18 +16,77 @@
 #include "HW_can.hpp"
 
 #include "stdint.h"
+#include "Dwt.hpp"
+#include "Clock.hpp"
+#include "CanStamp.hpp"
 
 /* Private macro -------------------------------------------------------------*/
 /* Private constants ---------------------------------------------------------*/
+static const uint32_t kCanRecoveryRetryMs = 10;  // 离线后重新初始化的重试间隔
+static const uint32_t kCanRecoveryTimeoutMs = 100;  // 重新初始化后等待确认的时间，超时按离线重试
+static const uint32_t kCanNotifications =
+    CAN_IT_TX_MAILBOX_EMPTY | CAN_IT_RX_FIFO0_MSG_PENDING |
+    CAN_IT_RX_FIFO1_MSG_PENDING | CAN_IT_ERROR_PASSIVE | CAN_IT_BUSOFF | CAN_IT_ERROR;
+static const uint32_t kCanIrqPriority = 1;  // CAN收发、错误中断的抢占优先级
+static const uint32_t kCanAllTxMailboxes =
+    CAN_TX_MAILBOX0 | CAN_TX_MAILBOX1 | CAN_TX_MAILBOX2;
+static const uint32_t kCanCyclesPerBit = 168;  // 168MHz主频，1Mbps波特率
+static const CanGovernorConfig kCanGovernorConfig = {
+    1000000,  // 1Mbps
+    100,      // 100ms统计窗口
+    700,      // 负载超过70%升一级
+    500,      // 负载低于50%降一级
+    50,       // 每窗口仲裁失败超过50次升一级
+    3,        // 最多把周期放大8倍
+};
+
 /* Private types -------------------------------------------------------------*/
+struct CanBusCtrl {
+  CAN_HandleTypeDef *hcan;
+  bool started;
+  bool tx_flushed;
+  volatile CanBusState state;
+  volatile uint32_t outage_start;
+  uint32_t last_retry;
+  CanBusStats stats;
+  uint64_t last_rx_stamp;
+};
+
 /* Private variables ---------------------------------------------------------*/
 static CAN_RxHeaderTypeDef rx_header;
 static uint8_t can_rx_data[8];
 uint32_t pTxMailbox;
 
+static CanBusCtrl can_bus[2] = {{&hcan1}, {&hcan2}};
+static CanRxStamper can_stamper[2] = {CanRxStamper(kCanCyclesPerBit),
+                                      CanRxStamper(kCanCyclesPerBit)};
+static CanGovernor can_governor[2] = {CanGovernor(kCanGovernorConfig),
+                                      CanGovernor(kCanGovernorConfig)};
+
 
 /* External variables --------------------------------------------------------*/
 /* Private function prototypes -----------------------------------------------*/
+static HAL_StatusTypeDef CanFilter_Config(CAN_HandleTypeDef *hcan);
+static HAL_StatusTypeDef CanBus_Configure(CAN_HandleTypeDef *hcan);
+static HAL_StatusTypeDef CanBus_Restart(CanBusCtrl *bus);
+static void CanBus_BeginOutage(CanBusCtrl *bus, CanBusState state);
+static void CanBus_EndOutage(CanBusCtrl *bus);
+static void CanBus_TxComplete(CAN_HandleTypeDef *hcan, uint8_t mailbox);
+
+static CanBusCtrl *CanBus_Find(CAN_HandleTypeDef *hcan) {
+  return (hcan->Instance == CAN2) ? &can_bus[1] : &can_bus[0];
+}
+
+/* 屏蔽CAN中断(以及同级和更低优先级的中断)，返回原来的BASEPRI；只会提高屏蔽级别，不会放开调用者已经屏蔽的中断 */
+static uint32_t CanBus_Lock(void) {
+  uint32_t basepri = __get_BASEPRI();
+  __set_BASEPRI_MAX(kCanIrqPriority << (8 - __NVIC_PRIO_BITS));
+  return basepri;
+}
+
+static void CanBus_Unlock(uint32_t basepri) {
+  __set_BASEPRI(basepri);
+}
 
 /**
  * @brief
@@ -36,25 +95,303 @@ uint32_t pTxMailbox;
  * @note        None
  */
 void CanFilter_Init(CAN_HandleTypeDef *hcan) {
+  if (CanFilter_Config(hcan) != HAL_OK) {
+    Error_Handler();
+  }
+}
+
+/**
+ * @brief   按拓扑生成的ID列表配置过滤器，失败时返回错误而不进入Error_Handler
+ * @param   hcan为CAN句柄
+ * @retval  HAL状态
+ * @note    16位列表模式，每组4个ID，进FIFO0；CAN2使用从14号开始的过滤器组
+ *          最后一组为16位掩码模式、接收全部ID进FIFO1：同时匹配时列表模式优先，
+ *          拓扑里的ID仍然进FIFO0，其它节点的帧进FIFO1，只计入总线负载后丢弃
+ **/
+template <uint8_t Bus>
+static HAL_StatusTypeDef CanFilter_ConfigBanks(CAN_HandleTypeDef *hcan) {
+  static constexpr auto banks = TopoFilterBanks<Bus>();
   CAN_FilterTypeDef canfilter;
 
   canfilter.FilterMode = CAN_FILTERMODE_IDLIST;
   canfilter.FilterScale = CAN_FILTERSCALE_16BIT;
-
   canfilter.FilterActivation = ENABLE;
-  canfilter.SlaveStartFilterBank = 14;
+  canfilter.SlaveStartFilterBank = kTopoFilterBanksPerBus;
   canfilter.FilterFIFOAssignment = CAN_FilterFIFO0;
 
+  for (size_t i = 0; i < banks.size(); i++) {
+    canfilter.FilterIdHigh = banks[i].id[0];
+    canfilter.FilterIdLow = banks[i].id[1];
+    canfilter.FilterMaskIdHigh = banks[i].id[2];
+    canfilter.FilterMaskIdLow = banks[i].id[3];
+    canfilter.FilterBank = Bus * kTopoFilterBanksPerBus + i;
+    if (HAL_CAN_ConfigFilter(hcan, &canfilter) != HAL_OK) {
+      return HAL_ERROR;
+    }
+  }
+
   canfilter.FilterMode = CAN_FILTERMODE_IDMASK;
-  canfilter.FilterScale = CAN_FILTERSCALE_32BIT;
   canfilter.FilterIdHigh = 0x0000;
   canfilter.FilterIdLow = 0x0000;
   canfilter.FilterMaskIdHigh = 0x0000;
   canfilter.FilterMaskIdLow = 0x0000;
-  canfilter.FilterBank = 0;
-  canfilter.FilterActivation = ENABLE;
-  if (HAL_CAN_ConfigFilter(hcan, &canfilter) != HAL_OK) {
-    Error_Handler();
+  canfilter.FilterFIFOAssignment = CAN_FilterFIFO1;
+  canfilter.FilterBank = Bus * kTopoFilterBanksPerBus + banks.size();
+  return HAL_CAN_ConfigFilter(hcan, &canfilter);
+}
+
+static HAL_StatusTypeDef CanFilter_Config(CAN_HandleTypeDef *hcan) {
+  if (hcan->Instance == CAN2) {
+    return CanFilter_ConfigBanks<kTopoCan2>(hcan);
+  }
+  return CanFilter_ConfigBanks<kTopoCan1>(hcan);
+}
+
+/**
+ * @brief   配置过滤器、启动CAN并使能接收与错误中断
+ * @param   hcan为CAN句柄
+ * @retval  HAL状态
+ **/
+static HAL_StatusTypeDef CanBus_Configure(CAN_HandleTypeDef *hcan) {
+  if (CanFilter_Config(hcan) != HAL_OK) {
+    return HAL_ERROR;
+  }
+  if (HAL_CAN_Start(hcan) != HAL_OK) {
+    return HAL_ERROR;
+  }
+  return HAL_CAN_ActivateNotification(hcan, kCanNotifications);
+}
+
+/**
+ * @brief   启动CAN总线并纳入错误恢复管理
+ * @param   hcan为CAN句柄
+ * @retval  none
+ * @note    启动失败不会进入Error_Handler，而是按离线处理，由CanBus_RecoveryPoll重试
+ **/
+void CanBus_Start(CAN_HandleTypeDef *hcan) {
+  CanBusCtrl *bus = CanBus_Find(hcan);
+  bus->started = true;
+#if CAN_RX_HW_TIMESTAMP
+  hcan->Init.TimeTriggeredMode = ENABLE;  // 开启内部计数器，接收邮箱带16位时间戳
+  if (HAL_CAN_Init(hcan) != HAL_OK) {
+    CanBus_BeginOutage(bus, kCanBusOff);  // 由CanBus_RecoveryPoll按同样的Init参数重试
+    return;
+  }
+#endif
+  if (CanBus_Configure(hcan) != HAL_OK) {
+    CanBus_BeginOutage(bus, kCanBusOff);
+  }
+}
+
+/**
+ * @brief   停止CAN、丢弃邮箱中的过期帧后重新初始化
+ * @param   bus为总线控制块
+ * @retval  HAL状态
+ * @note    HAL_CAN_Init在非RESET状态下不会重复调用MspInit
+ **/
+static HAL_StatusTypeDef CanBus_Restart(CanBusCtrl *bus) {
+  CAN_HandleTypeDef *hcan = bus->hcan;
+  if (hcan->State == HAL_CAN_STATE_LISTENING) {
+    HAL_CAN_AbortTxRequest(hcan, kCanAllTxMailboxes);
+    HAL_CAN_Stop(hcan);
+  }
+  if (HAL_CAN_Init(hcan) != HAL_OK) {
+    return HAL_ERROR;
+  }
+  can_stamper[bus - can_bus].reset();  // 重新初始化后CAN内部计数器从0开始
+  return CanBus_Configure(hcan);
+}
+
+static void CanBus_BeginOutage(CanBusCtrl *bus, CanBusState state) {
+  if (bus->state == kCanBusActive) {
+    bus->outage_start = HAL_GetTick();
+    bus->tx_flushed = false;
+  }
+  if (state == kCanBusOff) {
+    bus->stats.bus_off_count++;
+  } else {
+    bus->stats.error_passive_count++;
+  }
+  bus->state = state;
+}
+
+static void CanBus_EndOutage(CanBusCtrl *bus) {
+  uint32_t outage = HAL_GetTick() - bus->outage_start;
+  bus->stats.last_outage_ms = outage;
+  bus->stats.total_outage_ms += outage;
+  if (outage > bus->stats.max_outage_ms) {
+    bus->stats.max_outage_ms = outage;
+  }
+  bus->stats.recovery_count++;
+  bus->state = kCanBusActive;
+}
+
+/**
+ * @brief   总线恢复的轮询函数，在主循环(线程模式的协程)中调用
+ * @param   none
+ * @retval  none
+ * @note    重新初始化涉及HAL_GetTick的超时等待，不能放在中断中执行，包括PendSV：
+ *          PendSV与SysTick优先级相同，SysTick无法抢占，超时等待永远不会结束；
+ *          状态同时由CAN中断修改，读改写在屏蔽CAN中断后进行
+ **/
+void CanBus_RecoveryPoll(void) {
+  for (CanBusCtrl &bus : can_bus) {
+    if (!bus.started) {
+      continue;
+    }
+    switch (bus.state) {
+      case kCanBusPassive: {
+        // 检查和状态转换之间可能发生离线，整个读改写都在屏蔽CAN中断后进行
+        uint32_t basepri = CanBus_Lock();
+        if (bus.state == kCanBusPassive) {
+          if (!bus.tx_flushed) {  // 错误被动期间邮箱里的帧在反复重发，已经过期
+            HAL_CAN_AbortTxRequest(bus.hcan, kCanAllTxMailboxes);
+            bus.tx_flushed = true;
+          }
+          if ((bus.hcan->Instance->ESR & CAN_ESR_EPVF) == 0U) {
+            CanBus_EndOutage(&bus);
+          }
+        }
+        CanBus_Unlock(basepri);
+        break;
+      }
+      case kCanBusOff: {
+        // 重新初始化要等待HAL_GetTick超时，不能在屏蔽中断时进行，只在锁内完成状态转换
+        uint32_t basepri = CanBus_Lock();
+        bool retry = bus.state == kCanBusOff && HAL_GetTick() - bus.last_retry >= kCanRecoveryRetryMs;
+        if (retry) {
+          bus.last_retry = HAL_GetTick();
+          bus.state = kCanBusRecovering;
+        }
+        CanBus_Unlock(basepri);
+        if (retry && CanBus_Restart(&bus) != HAL_OK) {
+          basepri = CanBus_Lock();
+          if (bus.state == kCanBusRecovering) {
+            bus.state = kCanBusOff;
+          }
+          bus.stats.recovery_fail_count++;
+          CanBus_Unlock(basepri);
+        }
+        break;
+      }
+      case kCanBusRecovering: {
+        // 总线上没有其它节点发送、本板也一直发不出去时不会有确认，超时后重新初始化
+        uint32_t basepri = CanBus_Lock();
+        if (bus.state == kCanBusRecovering &&
+            HAL_GetTick() - bus.last_retry >= kCanRecoveryTimeoutMs) {
+          bus.state = kCanBusOff;
+          bus.stats.recovery_timeout_count++;
+        }
+        CanBus_Unlock(basepri);
+        break;
+      }
+      default:
+        break;
+    }
+  }
+}
+
+CanBusState CanBus_GetState(CAN_HandleTypeDef *hcan) {
+  return CanBus_Find(hcan)->state;
+}
+
+const CanBusStats *CanBus_GetStats(CAN_HandleTypeDef *hcan) {
+  return &CanBus_Find(hcan)->stats;
+}
+
+/**
+ * @brief   发送成功，运行在CAN发送中断中
+ * @param   hcan为CAN句柄
+ * @param   mailbox为发送邮箱序号
+ * @retval  none
+ * @note    只统计真正发到总线上的帧；重新初始化后能发出一帧(收到了应答)就说明总线已经恢复
+ **/
+static void CanBus_TxComplete(CAN_HandleTypeDef *hcan, uint8_t mailbox) {
+  CanBusCtrl *bus = CanBus_Find(hcan);
+  uint8_t dlc = hcan->Instance->sTxMailBox[mailbox].TDTR & CAN_TDT0R_DLC;
+  can_governor[bus - can_bus].countFrame(dlc);
+  if (bus->state == kCanBusRecovering) {
+    CanBus_EndOutage(bus);
+  }
+}
+
+void HAL_CAN_TxMailbox0CompleteCallback(CAN_HandleTypeDef *hcan) {
+  CanBus_TxComplete(hcan, 0);
+}
+
+void HAL_CAN_TxMailbox1CompleteCallback(CAN_HandleTypeDef *hcan) {
+  CanBus_TxComplete(hcan, 1);
+}
+
+void HAL_CAN_TxMailbox2CompleteCallback(CAN_HandleTypeDef *hcan) {
+  CanBus_TxComplete(hcan, 2);
+}
+
+/**
+ * @brief   带宽调节的轮询函数，在主循环中调用
+ * @param   none
+ * @retval  none
+ **/
+void CanBus_GovernorPoll(void) {
+  for (CanBusCtrl &bus : can_bus) {
+    if (!bus.started) {
+      continue;
+    }
+    can_governor[&bus - can_bus].update(HAL_GetTick());
+  }
+}
+
+CanGovernor *CanBus_GetGovernor(CAN_HandleTypeDef *hcan) {
+  return &can_governor[CanBus_Find(hcan) - can_bus];
+}
+
+/**
+ * @brief   最近一帧的接收时间
+ * @param   hcan为CAN句柄
+ * @retval  64位应用时间（CPU周期，DWT扩展）
+ * @note    64位读取不是原子的，屏蔽CAN中断后读取，避免读到接收中断写了一半的值
+ **/
+uint64_t CanBus_LastRxStamp(CAN_HandleTypeDef *hcan) {
+  CanBusCtrl *bus = CanBus_Find(hcan);
+  uint32_t basepri = CanBus_Lock();
+  uint64_t stamp = bus->last_rx_stamp;
+  CanBus_Unlock(basepri);
+  return stamp;
+}
+
+/**
+ * @brief   CAN错误中断的回调函数，只记录状态，恢复在CanBus_RecoveryPoll中完成
+ * @param   hcan为CAN句柄
+ * @retval  none
+ * @note    错误被动和离线标志为只读，由硬件在计数器回落后清除
+ **/
+void HAL_CAN_ErrorCallback(CAN_HandleTypeDef *hcan) {
+  CanBusCtrl *bus = CanBus_Find(hcan);
+  uint32_t esr = hcan->Instance->ESR;
+
+  uint32_t error = hcan->ErrorCode;
+
+  bus->stats.last_error_code = error;
+  hcan->ErrorCode = HAL_CAN_ERROR_NONE;
+
+  // 发送中断清除RQCP时，仲裁失败而结束的请求由HAL记为错误码；
+  // 仲裁失败后自动重发成功的请求看不到，仲裁失败次数偏少，见CanGovernor::countArbitrationLoss
+  uint32_t lost = ((error & HAL_CAN_ERROR_TX_ALST0) != 0U) +
+                  ((error & HAL_CAN_ERROR_TX_ALST1) != 0U) +
+                  ((error & HAL_CAN_ERROR_TX_ALST2) != 0U);
+  if (lost != 0U) {
+    can_governor[bus - can_bus].countArbitrationLoss(lost);
+  }
+
+  if ((esr & CAN_ESR_BOFF) != 0U) {
+    if (bus->state != kCanBusOff) {
+      CanBus_BeginOutage(bus, kCanBusOff);
+    }
+  } else if ((esr & CAN_ESR_EPVF) != 0U) {
+    // 重新初始化后等待确认期间也可能进入错误被动，之后按错误被动等待计数器回落
+    if (bus->state == kCanBusActive || bus->state == kCanBusRecovering) {
+      CanBus_BeginOutage(bus, kCanBusPassive);
+    }
   }
 }
 
@@ -70,23 +407,116 @@ uint32_t can_receive_data = 0;
  * @note
  **/
 void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan) {
+  uint32_t isr_cycles = Dwt_Cycles();  // 尽早记录进入中断的时刻
 
   if (HAL_CAN_GetRxMessage(hcan, CAN_RX_FIFO0, &rx_header, can_rx_data) ==
       HAL_OK) // 获得接收到的数据头和数据
   {
-    if (rx_header.StdId == 0x321) { // 帧头校验
-                                     // 校验通过进行具体数据处理
-    }if (rx_header.StdId >= 0x205 && rx_header.StdId <= 0x20B){ //检测GM6020电机的帧头
-      uint8_t motor_id = rx_header.StdId - 0x204;  //计算电机id
-      if(motor_id >= 1 && motor_id <= 7){ 
-        motors[motor_id - 1].decode(can_rx_data);  //解密数据，并存放对应id的motors中
-      }
+    CanBusCtrl *bus = CanBus_Find(hcan);
+#if CAN_RX_HW_TIMESTAMP
+    uint64_t stamp = can_stamper[bus - can_bus].stamp(Clock_Extend(isr_cycles), rx_header.Timestamp);
+#else
+    uint64_t stamp = can_stamper[bus - can_bus].stamp(Clock_Extend(isr_cycles));
+#endif
+    bus->last_rx_stamp = stamp;
+    can_governor[bus - can_bus].countFrame(rx_header.DLC);  // 统计总线负载
+    if (bus->state == kCanBusRecovering) { // 重新初始化后收到第一帧，总线恢复
+      CanBus_EndOutage(bus);
+    }
+    TopoRoute route = TopoDispatch(bus - can_bus, rx_header.StdId);  // 按拓扑生成的分发表查找设备
+    if (route.type == kTopoGM6020) {
+      motors[route.index].decode(can_rx_data);  //解密数据，并存放对应的motors中
+      motors[route.index].setRxStamp(stamp);
+      CAN_MotorFeedbackCallback(hcan, route.index);  //通知应用层，可在此触发控制
+    } else if (route.type == kTopoBoardLink) {
+      CAN_BoardLinkCallback(hcan, can_rx_data, rx_header.DLC);
+    } else if (route.type == kTopoCommand) {
+      CAN_CommandCallback(hcan, rx_header.StdId, can_rx_data, rx_header.DLC);
     }
   }
   HAL_CAN_ActivateNotification(
       hcan, CAN_IT_RX_FIFO0_MSG_PENDING); // 再次使能FIFO0接收中断
 }
 
+/**
+ * @brief   FIFO1接收中断的回调函数：拓扑以外的帧，只计入总线负载
+ * @param   hcan为CAN句柄
+ * @retval  none
+ * @note    与FIFO0接收中断优先级相同，不会互相打断
+ **/
+void HAL_CAN_RxFifo1MsgPendingCallback(CAN_HandleTypeDef *hcan) {
+  CAN_RxHeaderTypeDef header;
+  uint8_t data[8];
+
+  if (HAL_CAN_GetRxMessage(hcan, CAN_RX_FIFO1, &header, data) == HAL_OK) {
+    CanBusCtrl *bus = CanBus_Find(hcan);
+    can_governor[bus - can_bus].countFrame(header.DLC);
+    if (bus->state == kCanBusRecovering) {  // 收到任何一帧都说明总线已经恢复
+      CanBus_EndOutage(bus);
+    }
+  }
+}
+
+/**
+ * @brief   电机反馈解码完成的回调，运行在CAN接收中断中
+ * @param   hcan为CAN句柄
+ * @param   motor_index为电机在motors中的下标
+ * @retval  none
+ * @note    弱定义，应用层可以重新实现
+ **/
+__weak void CAN_MotorFeedbackCallback(CAN_HandleTypeDef *hcan,
+                                      uint8_t motor_index) {
+  UNUSED(hcan);
+  UNUSED(motor_index);
+}
+
+/**
+ * @brief   板间通信帧的回调，运行在CAN接收中断中
+ * @param   hcan为CAN句柄
+ * @param   data为帧数据
+ * @param   len为数据长度
+ * @retval  none
+ * @note    弱定义，应用层可以重新实现
+ **/
+__weak void CAN_BoardLinkCallback(CAN_HandleTypeDef *hcan, uint8_t *data,
+                                  uint8_t len) {
+  UNUSED(hcan);
+  UNUSED(data);
+  UNUSED(len);
+}
+
+/**
+ * @brief   命令帧的回调，运行在CAN接收中断中
+ * @param   hcan为CAN句柄
+ * @param   id为帧ID
+ * @param   data为帧数据
+ * @param   len为数据长度
+ * @retval  none
+ * @note    弱定义，应用层可以重新实现；中断中只应把帧放进队列，由协程处理
+ **/
+__weak void CAN_CommandCallback(CAN_HandleTypeDef *hcan, uint32_t id, uint8_t *data,
+                                uint8_t len) {
+  UNUSED(hcan);
+  UNUSED(id);
+  UNUSED(data);
+  UNUSED(len);
+}
+
+/**
+ * @brief   把一个控制帧分组内所有电机的输入合成一帧发出
+ * @param   group为kTopoTxGroups中的下标
+ * @retval  none
+ * @note    分组在编译期由拓扑生成，组内没有电机的槽位发送0
+ **/
+void CAN_SendMotorGroup(uint8_t group) {
+  const TopoTxGroup &g = kTopoTxGroups[group];
+  uint8_t data[8] = {0};
+  for (uint8_t i = 0; i < g.count; i++) {
+    motors[g.motors[i]].encode(data);
+  }
+  CAN_Send_Msg(can_bus[g.bus].hcan, data, g.tx_id, 8);
+}
+
 /**
  * @brief   向can总线发送数据，抄官方的
  * @param   hcan为CAN句柄
@@ -98,12 +528,31 @@ void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan) {
  **/
 void CAN_Send_Msg(CAN_HandleTypeDef *hcan, uint8_t *msg, uint32_t id,
                   uint8_t len) {
+  CAN_TrySend_Msg(hcan, msg, id, len, 0);
+}
+
+/**
+ * @brief   空闲发送邮箱多于reserve个时发送一帧
+ * @param   hcan为CAN句柄
+ * @param	  msg为发送数组首地址
+ * @param	  id为发送报文id
+ * @param	  len为发送数据长度（字节数）
+ * @param   reserve为要留给其它发送方的邮箱数
+ * @retval  放进发送邮箱返回true
+ * @note    HAL_CAN_AddTxMessage不可重入，控制帧在CAN接收中断里发送，其它帧在PendSV、TIM6中发送，
+ *          检查空闲邮箱和放入邮箱都在屏蔽CAN中断后完成，两个发送方不会抢到同一个邮箱
+ **/
+bool CAN_TrySend_Msg(CAN_HandleTypeDef *hcan, uint8_t *msg, uint32_t id,
+                     uint8_t len, uint8_t reserve) {
   CAN_TxHeaderTypeDef TxMessageHeader = {0};
   TxMessageHeader.StdId = id;
   TxMessageHeader.IDE = CAN_ID_STD;
   TxMessageHeader.RTR = CAN_RTR_DATA;
   TxMessageHeader.DLC = len;
-  if (HAL_CAN_AddTxMessage(hcan, &TxMessageHeader, msg, &pTxMailbox) !=
-      HAL_OK) {
-  }
+
+  uint32_t basepri = CanBus_Lock();
+  bool sent = HAL_CAN_GetTxMailboxesFreeLevel(hcan) > reserve &&
+              HAL_CAN_AddTxMessage(hcan, &TxMessageHeader, msg, &pTxMailbox) == HAL_OK;
+  CanBus_Unlock(basepri);  // 发出的帧在发送完成中断中计入总线负载
+  return sent;
 }
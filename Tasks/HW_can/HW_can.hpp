@@ -20,15 +20,68 @@
 #include "main.h"
 #include "GM6020.hpp"
 #include "can.h"
+#include "BoardLink.hpp"
+#include "CanGovernor.hpp"
+#include "Topology.hpp"
 /* Exported macro ------------------------------------------------------------*/
+/* 置1时开启bxCAN时间触发模式，用硬件时间戳修正接收中断的延迟；
+ * 置0时直接以进入接收中断时的DWT周期数作为接收时间 */
+#ifndef CAN_RX_HW_TIMESTAMP
+#define CAN_RX_HW_TIMESTAMP 0
+#endif
+
 /* Exported types ------------------------------------------------------------*/
-extern GM6020 motors[7];  //引入全局变量motors，方便接收函数更新
+enum CanBusState {
+  kCanBusActive = 0,  // 正常通信
+  kCanBusPassive,     // 错误被动，仍可通信但发送受限
+  kCanBusOff,         // 离线，等待恢复
+  kCanBusRecovering,  // 已重新初始化，等待收到一帧或发送成功一帧确认总线恢复
+};
+
+struct CanBusStats {
+  uint32_t error_passive_count;  // 进入错误被动的次数
+  uint32_t bus_off_count;        // 进入离线的次数
+  uint32_t recovery_count;       // 成功恢复的次数
+  uint32_t recovery_fail_count;  // 重新初始化失败的次数
+  uint32_t recovery_timeout_count;  // 重新初始化后超时仍未确认恢复的次数
+  uint32_t last_outage_ms;       // 最近一次故障持续时间
+  uint32_t max_outage_ms;        // 最长一次故障持续时间
+  uint32_t total_outage_ms;      // 故障累计时间
+  uint32_t last_error_code;      // 最近一次HAL错误码
+};
+
+extern std::array<GM6020, kTopoMotorNum> motors;  //引入全局变量motors，方便接收函数更新
 
 void CanFilter_Init(CAN_HandleTypeDef *hcan);
 
+void CanBus_Start(CAN_HandleTypeDef *hcan);
+
+void CanBus_RecoveryPoll(void);
+
+CanBusState CanBus_GetState(CAN_HandleTypeDef *hcan);
+
+const CanBusStats *CanBus_GetStats(CAN_HandleTypeDef *hcan);
+
+uint64_t CanBus_LastRxStamp(CAN_HandleTypeDef *hcan);
+
+void CanBus_GovernorPoll(void);
+
+CanGovernor *CanBus_GetGovernor(CAN_HandleTypeDef *hcan);
+
+void CAN_MotorFeedbackCallback(CAN_HandleTypeDef *hcan, uint8_t motor_index);
+
+void CAN_BoardLinkCallback(CAN_HandleTypeDef *hcan, uint8_t *data, uint8_t len);
+
+void CAN_CommandCallback(CAN_HandleTypeDef *hcan, uint32_t id, uint8_t *data, uint8_t len);
+
+void CAN_SendMotorGroup(uint8_t group);
+
 void CAN_Send_Msg(CAN_HandleTypeDef *hcan, uint8_t *msg, uint32_t id,
                   uint8_t len);
 
+bool CAN_TrySend_Msg(CAN_HandleTypeDef *hcan, uint8_t *msg, uint32_t id,
+                     uint8_t len, uint8_t reserve);
+
 
 
 #endif /* _HW_CAN_H_ */
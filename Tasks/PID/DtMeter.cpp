@@ -0,0 +1,59 @@
+#include "DtMeter.hpp"
+
+static const float kDtClampRatio = 2.0f;     // 正常测量值限幅到[nominal/2, nominal*2]
+static const float kDtFallbackRatio = 4.0f;  // 超过名义周期4倍认为中间停过，退回名义周期
+
+void DtMeter::reset(void)
+{
+  started_ = false;
+  last_ = 0;
+  dt_ = 0;
+  nominal_ = 0;
+  hist_scale_ = 0;
+  dt_min_ = 1e9f;
+  dt_max_ = 0;
+  samples_ = anomalies_ = 0;
+  for (uint8_t i = 0; i < kDtHistBins; i++)
+    hist_[i] = 0;
+}
+
+/**
+  * @brief  读取周期计数器，返回距上次调用的时间
+  * @param  nominal为名义采样周期(s)
+  * @retval 用于本次计算的采样周期(s)
+  */
+float DtMeter::measure(const float nominal)
+{
+  uint32_t now = cycles_();
+  uint32_t elapsed = now - last_;  // 无符号相减，计数器回绕一次以内都正确
+  last_ = now;
+
+  if (!started_) {
+    started_ = true;
+    dt_ = nominal;
+    return dt_;
+  }
+
+  float dt = elapsed * inv_hz_;
+  samples_++;
+  if (dt < dt_min_) dt_min_ = dt;
+  if (dt > dt_max_) dt_max_ = dt;
+
+  if (nominal != nominal_) {   // 名义周期很少变化，直方图的比例只在变化时计算
+    nominal_ = nominal;
+    hist_scale_ = (kDtHistBins / 2) / nominal;
+  }
+  uint32_t bin = static_cast<uint32_t>(dt * hist_scale_ + 0.5f);  // 第k格以k/8倍名义周期为中心
+  hist_[bin < kDtHistBins ? bin : kDtHistBins - 1]++;
+
+  if (elapsed == 0 || dt > nominal * kDtFallbackRatio) {
+    anomalies_++;
+    dt = nominal;
+  } else if (dt > nominal * kDtClampRatio) {
+    dt = nominal * kDtClampRatio;
+  } else if (dt < nominal / kDtClampRatio) {
+    dt = nominal / kDtClampRatio;
+  }
+  dt_ = dt;
+  return dt;
+}
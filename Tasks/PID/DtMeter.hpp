@@ -0,0 +1,41 @@
+#ifndef _DT_METER_H_
+#define _DT_METER_H_
+
+#include <stdint.h>
+
+/*
+ * 用周期计数器测量两次调用之间的实际采样周期
+ * 测得的dt限制在名义周期的[1/2, 2]倍之内；首次调用、计数器停走或间隔超过名义周期4倍(中间停过控制)时
+ * 视为异常，返回名义周期
+ * 直方图按名义周期归一化，每格宽1/8个名义周期，第8格对应名义周期，超出2倍的计入最后一格
+ */
+static const uint8_t kDtHistBins = 16;
+
+class DtMeter {
+  public:
+    DtMeter(uint32_t cpu_hz, uint32_t (*cycles)(void)) { cycles_ = cycles; inv_hz_ = 1.0f / cpu_hz; reset(); };
+    ~DtMeter() = default;
+    void reset(void);
+    float measure(const float nominal);
+    float dt(void){ return dt_; };
+    float dtMin(void){ return dt_min_; };
+    float dtMax(void){ return dt_max_; };
+    uint32_t samples(void){ return samples_; };
+    uint32_t anomalies(void){ return anomalies_; };
+    const uint32_t *histogram(void){ return hist_; };
+  private:
+    uint32_t (*cycles_)(void);
+    float inv_hz_;
+    uint32_t last_;
+    bool started_;
+    float dt_;          /*最近一次返回的dt*/
+    float nominal_;     /*hist_scale_对应的名义周期*/
+    float hist_scale_;  /*(kDtHistBins/2)/nominal_*/
+    float dt_min_;      /*未经限幅的测量值*/
+    float dt_max_;
+    uint32_t samples_;
+    uint32_t anomalies_;
+    uint32_t hist_[kDtHistBins];
+};
+
+#endif
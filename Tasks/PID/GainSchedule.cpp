@@ -0,0 +1,71 @@
+#include "GainSchedule.hpp"
+
+/**
+ * @brief   载入一张新表，在下一次pidCalc时生效
+ * @param   points为断点，x必须严格递增
+ * @param   count为断点数，1 ~ kGainScheduleMaxPoints
+ * @retval  表不合法或上一张表还没换入时返回false
+ */
+bool GainSchedule::load(const GainPoint *points, uint8_t count)
+{
+  if (count == 0 || count > kGainScheduleMaxPoints)
+    return false;
+  for (uint8_t i = 1; i < count; i++)
+    if (!(points[i].x > points[i - 1].x))
+      return false;
+  if (pending_.load(std::memory_order_acquire))
+    return false;
+
+  GainTable &t = tables_[active_ ^ 1];
+  t.count = count;
+  for (uint8_t i = 0; i < count; i++) {
+    t.x[i] = points[i].x;
+    t.kp[i] = points[i].kp;
+    t.ki[i] = points[i].ki;
+    t.kd[i] = points[i].kd;
+    t.inv_dx[i] = i + 1 < count ? 1.0f / (points[i + 1].x - points[i].x) : 0;
+  }
+  pending_.store(1, std::memory_order_release);
+  return true;
+}
+
+/**
+ * @brief   按调度变量更新增益后计算一次PID
+ * @param   ref、fdb、T同Pid::pidCalc
+ * @param   x为调度变量
+ * @retval  PID输出
+ * @note    没有载入表时直接使用Pid当前的增益
+ */
+float GainSchedule::pidCalc(const float ref, const float fdb, const float T, const float x)
+{
+  if (pending_.load(std::memory_order_acquire)) {
+    active_ ^= 1;
+    pending_.store(0, std::memory_order_release);
+  }
+
+  const GainTable &t = tables_[active_];
+  if (t.count == 0)
+    return pid_.pidCalc(ref, fdb, T);
+
+  if (x <= t.x[0]) {
+    pid_.setGains(t.kp[0], t.ki[0], t.kd[0]);
+  } else if (x >= t.x[t.count - 1]) {
+    uint8_t n = t.count - 1;
+    pid_.setGains(t.kp[n], t.ki[n], t.kd[n]);
+  } else {
+    // 二分查找x所在区间[lo, lo+1]
+    uint8_t lo = 0, hi = t.count - 1;
+    while (hi - lo > 1) {
+      uint8_t mid = (lo + hi) / 2;
+      if (t.x[mid] <= x)
+        lo = mid;
+      else
+        hi = mid;
+    }
+    float r = (x - t.x[lo]) * t.inv_dx[lo];
+    pid_.setGains(t.kp[lo] + r * (t.kp[hi] - t.kp[lo]),
+                  t.ki[lo] + r * (t.ki[hi] - t.ki[lo]),
+                  t.kd[lo] + r * (t.kd[hi] - t.kd[lo]));
+  }
+  return pid_.pidCalc(ref, fdb, T);
+}
@@ -0,0 +1,45 @@
+#ifndef _GAIN_SCHEDULE_H_
+#define _GAIN_SCHEDULE_H_
+
+#include "PID.hpp"
+#include <atomic>
+
+/*
+ * 增益调度：按调度变量x(|误差|、转速、负载电流等)查断点表，线性插值得到kp、ki、kd后交给Pid计算
+ * 断点按x升序，二分查找O(log k)；x超出表的范围时取端点的增益
+ * 增益随x连续变化，Pid::setGains保持积分项不变(包括ki经过0)，切换区间时输出不跳变
+ * 表可以在运行时由低优先级上下文load()，在下一次pidCalc开始时整表换入，写法与PidStore相同
+ */
+static const uint8_t kGainScheduleMaxPoints = 16;
+
+struct GainPoint {
+  float x;
+  float kp;
+  float ki;
+  float kd;
+};
+
+struct GainTable {
+  uint8_t count;
+  float x[kGainScheduleMaxPoints];
+  float kp[kGainScheduleMaxPoints];
+  float ki[kGainScheduleMaxPoints];
+  float kd[kGainScheduleMaxPoints];
+  float inv_dx[kGainScheduleMaxPoints];   /*1/(x[i+1]-x[i])，载入时算好，插值时不做除法*/
+};
+
+class GainSchedule {
+  public:
+    GainSchedule(Pid &pid) : pid_(pid) { tables_[0].count = tables_[1].count = 0; active_ = 0; pending_.store(0); };
+    ~GainSchedule() = default;
+    bool load(const GainPoint *points, uint8_t count);
+    float pidCalc(const float ref, const float fdb, const float T, const float x);
+    uint8_t count(void){ return tables_[active_].count; };
+  private:
+    Pid &pid_;
+    GainTable tables_[2];
+    uint8_t active_;
+    std::atomic<uint8_t> pending_;
+};
+
+#endif
@@ -4,6 +4,85 @@
 void Pid::setParams(PidParams &params)
 {
   params_ = params;
+  updateParamCoeffs();
+  T_ = 0;     // 下一次pidCalc重新计算系数
+  datas_.saturated = 0;
+  datas_.bias = 0;   // 新参数从积分开始，需要保持输出时用transferParams
+}
+
+/**
+ * @brief   只修改增益，保持积分项(ki*integral + bias)不变，输出不会因为ki变化而跳变
+ * @param   kp、ki、kd为新增益
+ * @retval  None
+ * @note    ki变为0时积分项转入bias，ki再变为非0时转回积分；转回时受积分限幅约束
+ *          增益调度每个周期调用：与采样周期有关的系数不重算，kd_T_用缓存的倒数得到，
+ *          只有ki变化时求一次1/ki
+ */
+void Pid::setGains(float kp, float ki, float kd)
+{
+  if (kp == params_.kp && ki == params_.ki && kd == params_.kd)
+    return;
+  params_.kp = kp;
+  params_.kd = kd;
+  kd_T_ = kd * inv_d_;
+  if (ki != params_.ki) {
+    float i_term = params_.ki * datas_.integral + datas_.bias;
+    params_.ki = ki;
+    updateParamCoeffs();
+    back_calc_ = back_gain_ * T_;
+    matchOutput(0, i_term);
+  }
+}
+
+/*
+ * 设置积分使others + ki*integral等于output，others为P、D项之和，受积分限幅约束
+ * ki为0时没有积分，差值放进bias
+ */
+void Pid::matchOutput(const float others, const float output)
+{
+  if (params_.ki == 0) {
+    datas_.integral = 0;
+    datas_.bias = output - others;
+    return;
+  }
+  float integral = (output - others) * inv_ki_;
+  if (integral > params_.integral_limit)
+    integral = params_.integral_limit;
+  else if (integral < -params_.integral_limit)
+    integral = -params_.integral_limit;
+  datas_.integral = integral;
+  datas_.bias = 0;
+}
+
+/**
+ * @brief   无扰地更换参数：重设积分，使上一拍的误差在新参数下得到相同的输出
+ * @param   params为新参数
+ * @retval  None
+ */
+void Pid::transferParams(PidParams &params)
+{
+  setParams(params);
+  float p = params_.kp * (params_.b * datas_.last_ref - datas_.last_fdb);
+  matchOutput(p + datas_.derivative, datas_.last_output);
+}
+
+/**
+ * @brief   跟踪模式：控制器未启用时每个周期调用，内部状态跟随正在使用的输出
+ * @param   ref、fdb为本控制器的参考值和反馈值
+ * @param   output为实际发给执行器的输出
+ * @retval  None
+ * @note    微分项按切换前一拍的反馈计算，切换时没有微分冲击
+ */
+void Pid::track(const float ref, const float fdb, const float output)
+{
+  float error = ref - fdb;
+  datas_.derivative = 0;
+  matchOutput(params_.kp * (params_.b * ref - fdb), output);
+  datas_.last_error = error;
+  datas_.last_fdb = fdb;
+  datas_.last_ref = ref;
+  datas_.last_output = output;
+  datas_.saturated = 0;
 }
 
 PidParams Pid::getParams(void) 
@@ -11,36 +90,102 @@ PidParams Pid::getParams(void)
   return params_;
 }
 
+/*只与参数有关的系数，换参数时计算，只有一次除法1/ki*/
+void Pid::updateParamCoeffs(void)
+{
+  separation_ = params_.separation > 0 ? params_.separation : INFINITY;
+  inv_ki_ = params_.ki != 0 ? 1.0f / params_.ki : 0;
+  back_gain_ = params_.tracking_gain * inv_ki_;
+}
+
+/*
+ * 与采样周期有关的系数，只在采样周期变化时计算
+ * 不滤波时直接算kd/T，与逐次除以T的结果逐位相同；1/T另外缓存，setGains改kd时不用再除
+ */
+void Pid::updateCoeffs(const float T)
+{
+  T_ = T;
+  half_T_ = T * 0.5f;
+  if (params_.Tf > 0) {
+    inv_d_ = 1.0f / (params_.Tf + T);
+    kd_T_ = params_.kd * inv_d_;
+    d_alpha_ = params_.Tf * inv_d_;
+  } else {
+    inv_d_ = 1.0f / T;
+    kd_T_ = params_.kd / T;
+    d_alpha_ = 0;
+  }
+  back_calc_ = back_gain_ * T;
+}
+
+/**
+ * @brief   采样周期由meter实测的pidCalc
+ * @param   ref、fdb为参考值和反馈值
+ * @param   meter为该控制器的周期测量器，T为名义周期
+ * @retval  限幅后的输出
+ * @note    实测周期与当前系数的周期相差不超过kPidDtTolerance时沿用当前系数，
+ *          只有周期真正变化时才重新计算，正常的抖动不产生除法
+ */
+float Pid::pidCalc(const float ref, const float fdb, DtMeter &meter, const float T)
+{
+  float dt = meter.measure(T);
+  if (fabsf(dt - T_) <= T_ * kPidDtTolerance)
+    dt = T_;
+  return pidCalc(ref, fdb, dt);
+}
+
 float Pid::pidCalc(const float ref, const float fdb, const float T)
 {
+    if (T != T_)
+        updateCoeffs(T);
+
     float error = ref - fdb;
     
-    // 积分分离
+    // 积分分离；条件积分时，输出已经饱和且误差同向则不再积分
     float integral = datas_.integral;
-    if (fabs(error) < 35.0f) { 
-        integral += (error + datas_.last_error) / 2 * T;
+    bool integrate = fabsf(error) < separation_;
+    if (params_.anti_windup == kPidWindupConditional && datas_.saturated * error > 0)
+        integrate = false;
+    if (integrate) { 
+        integral += (error + datas_.last_error) * half_T_;
     }
     
-    // 微分先行
-    float derivative = (datas_.last_fdb - fdb) / T; // 对测量值微分
-    
     datas_.integral = integral;
     if (datas_.integral > params_.integral_limit) 
         datas_.integral = params_.integral_limit;
     else if (datas_.integral < -params_.integral_limit) 
         datas_.integral = -params_.integral_limit;
     
-    float output = params_.kp * error 
+    // 微分先行，c=0时只对测量值微分；一阶滤波
+    float derivative = d_alpha_ * datas_.derivative
+                       + kd_T_ * ((datas_.last_fdb - fdb) + params_.c * (ref - datas_.last_ref));
+    datas_.derivative = derivative;
+
+    float output = params_.kp * (params_.b * ref - fdb) 
                    + params_.ki * integral 
-                   + params_.kd * derivative;
+                   + derivative
+                   + datas_.bias;
     
     datas_.last_error = error;
     datas_.last_fdb = fdb; // 保存当前测量值
+    datas_.last_ref = ref;
 
-    if (output > params_.output_limit) 
-        output = params_.output_limit;
-    else if (output < -params_.output_limit) 
-        output = -params_.output_limit;
+    float limited = output;
+    if (limited > params_.output_limit) 
+        limited = params_.output_limit;
+    else if (limited < -params_.output_limit) 
+        limited = -params_.output_limit;
+    datas_.saturated = (limited < output) - (limited > output);
 
-    return output;
-}
\ No newline at end of file
+    // 反算：饱和量(limited - output)按跟踪增益回馈到积分，修正后同样受积分限幅约束
+    if (params_.anti_windup == kPidWindupBackCalc && datas_.saturated != 0) {
+        datas_.integral += back_calc_ * (limited - output);
+        if (datas_.integral > params_.integral_limit)
+            datas_.integral = params_.integral_limit;
+        else if (datas_.integral < -params_.integral_limit)
+            datas_.integral = -params_.integral_limit;
+    }
+
+    datas_.last_output = limited;
+    return limited;
+}
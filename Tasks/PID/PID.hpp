@@ -2,6 +2,17 @@
 #define _PID_H_
 
 #include "main.h"
+#include "DtMeter.hpp"
+
+/*实测采样周期与当前系数对应的周期相差不超过该比例时沿用当前系数，不重新计算*/
+static const float kPidDtTolerance = 0.01f;
+
+/*抗积分饱和策略，积分限幅integral_limit在任何策略下都生效*/
+enum PidAntiWindup : uint8_t {
+  kPidWindupClamp = 0,      // 只做积分限幅
+  kPidWindupConditional,    // 条件积分：上一拍输出饱和且误差使输出继续往饱和方向走时停止积分
+  kPidWindupBackCalc,       // 反算：按饱和量乘跟踪增益把积分往回拉
+};
 
 struct PidParams{
   float kp;
@@ -9,26 +20,63 @@ struct PidParams{
   float kd;
   float integral_limit; 
   float output_limit;  
+  float separation = 35.0f;                    // 积分分离阈值，|误差|不小于该值时不积分，0表示不分离
+  PidAntiWindup anti_windup = kPidWindupClamp;
+  float tracking_gain = 0;                     // 反算的跟踪增益Kt(1/s)，常取ki/kp附近
+  float b = 1.0f;                              // 比例项的设定值权重，P = kp*(b*ref - fdb)
+  float c = 0;                                 // 微分项的设定值权重，0为只对测量值微分
+  float Tf = 0;                                // 微分一阶滤波时间常数(s)，0为不滤波
 };
 
 struct PidData{
   float integral;
   float last_error;
   float last_fdb;
+  int8_t saturated;   /*上一拍输出饱和的方向，1、-1，未饱和为0*/
+  float last_output;  /*上一拍限幅后的输出，无扰切换时保持它不变*/
+  float last_ref;
+  float derivative;   /*滤波后的微分项*/
+  float bias;         /*ki为0时代替积分项的输出偏置，无扰切换时由matchOutput设置*/
 };
 
+/*
+ * 离散系数在setParams或采样周期变化时预先算好，pidCalc中只有乘加，没有除法；
+ *   与参数有关的倒数在换参数时算好，采样周期变化时才重算1/(Tf+T)；setGains只改增益，不重算与周期有关的系数
+ * 与逐次计算T/2、除以T的写法相比，P、I项逐位相同，D项相对误差不超过2ulp(约2.4e-7)
+ * 二自由度：P、D项按设定值权重b、c计算，D项经过时间常数Tf的一阶滤波(后向差分离散)，
+ *   D = Tf/(Tf+T)*D' + kd/(Tf+T)*(c*Δref - Δfdb)；b=1、c=0、Tf=0时与单自由度的结果逐位相同
+ * 无扰切换：transferParams换参数时重设积分使输出不变；切换控制模式时，未启用的控制器
+ * 每个周期用track()跟踪正在使用的输出，切到它时输出从当前值连续开始
+ */
 class Pid {
   public:
-    Pid(PidParams &params) { params_ = params; 
-                             datas_.integral = datas_.last_error = 0;};
+    Pid(PidParams &params) { params_ = params; T_ = 0; inv_d_ = 0; updateParamCoeffs();
+                             datas_.integral = datas_.last_error = datas_.last_fdb = 0;
+                             datas_.saturated = 0; datas_.last_output = 0;
+                             datas_.last_ref = datas_.derivative = datas_.bias = 0;};
     ~Pid() = default;
     void setParams(PidParams &params);
+    void setGains(float kp, float ki, float kd);
+    void transferParams(PidParams &params);
+    void track(const float ref, const float fdb, const float output);
     PidParams getParams(void);
     float pidCalc(const float ref, const float fdb, const float T);
+    float pidCalc(const float ref, const float fdb, DtMeter &meter, const float T);
   private:
+    void updateParamCoeffs(void);
+    void updateCoeffs(const float T);
+    void matchOutput(const float others, const float output);
     PidParams params_;
     PidData datas_;
-
+    float T_;         /*当前系数对应的采样周期，0表示需要重新计算*/
+    float half_T_;    /*T/2，梯形积分*/
+    float kd_T_;      /*kd/(Tf+T)，微分*/
+    float d_alpha_;   /*Tf/(Tf+T)，微分滤波*/
+    float inv_d_;     /*1/(Tf+T)，不滤波时为1/T，setGains改kd时用*/
+    float separation_;   /*积分分离阈值，不分离时为无穷大*/
+    float inv_ki_;       /*1/ki，ki为0时为0*/
+    float back_gain_;    /*Kt/ki，与采样周期无关*/
+    float back_calc_;    /*Kt*T/ki，反算时积分的修正系数*/
 };
 
-#endif
\ No newline at end of file
+#endif
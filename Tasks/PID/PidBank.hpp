@@ -0,0 +1,117 @@
+#ifndef _PID_BANK_H_
+#define _PID_BANK_H_
+
+#include "PID.hpp"
+#include <stddef.h>
+#include "math.h"
+
+/*
+ * N路PID批量计算：参数和状态按数组分开存放(SoA)，一次循环算完所有轴
+ * 计算公式与Pid::pidCalc相同，所有轴共用一个采样周期
+ * 抗积分饱和只支持积分限幅(kPidWindupClamp)，不支持二自由度权重和微分滤波：
+ *   setParams拒绝anti_windup、b、c、Tf不是默认值的参数，这些轴应该用Pid
+ * enable_mask的第i位为0时第i轴不计算，输出和内部状态保持不变
+ */
+template <size_t N>
+class PidBank {
+    static_assert(N >= 1 && N <= 32, "PidBank supports 1..32 axes");
+  public:
+    PidBank(float T);
+    ~PidBank() = default;
+    bool setParams(size_t axis, const PidParams &params);
+    void setSampleTime(float T);
+    void reset(size_t axis) { integral_[axis] = last_error_[axis] = last_fdb_[axis] = 0; };
+    void calc(const float *ref, const float *fdb, float *out, uint32_t enable_mask);
+  private:
+    float kp_[N];
+    float ki_[N];
+    float kd_[N];
+    float kd_T_[N];
+    float integral_limit_[N];
+    float output_limit_[N];
+    float separation_[N];   /*不分离时为无穷大*/
+    float integral_[N];
+    float last_error_[N];
+    float last_fdb_[N];
+    float T_;
+    float half_T_;
+};
+
+template <size_t N>
+PidBank<N>::PidBank(float T)
+{
+  const PidParams zero = {0, 0, 0, 0, 0};
+  T_ = T;
+  half_T_ = T * 0.5f;
+  for (size_t i = 0; i < N; i++) {
+    setParams(i, zero);
+    reset(i);
+  }
+}
+
+/**
+ * @brief   设置一个轴的参数
+ * @param   axis为轴序号，params为参数
+ * @retval  成功返回true；轴序号越界或参数用到了不支持的功能时返回false，该轴参数不变
+ */
+template <size_t N>
+bool PidBank<N>::setParams(size_t axis, const PidParams &params)
+{
+  if (axis >= N || params.anti_windup != kPidWindupClamp || params.b != 1.0f || params.c != 0 ||
+      params.Tf != 0)
+    return false;
+  kp_[axis] = params.kp;
+  ki_[axis] = params.ki;
+  kd_[axis] = params.kd;
+  kd_T_[axis] = params.kd / T_;
+  integral_limit_[axis] = params.integral_limit;
+  output_limit_[axis] = params.output_limit;
+  separation_[axis] = params.separation > 0 ? params.separation : INFINITY;
+  return true;
+}
+
+template <size_t N>
+void PidBank<N>::setSampleTime(float T)
+{
+  T_ = T;
+  half_T_ = T * 0.5f;
+  for (size_t i = 0; i < N; i++)
+    kd_T_[i] = kd_[i] / T;
+}
+
+template <size_t N>
+void PidBank<N>::calc(const float *ref, const float *fdb, float *out, uint32_t enable_mask)
+{
+  for (size_t i = 0; i < N; i++) {
+    if (!(enable_mask & (1u << i)))
+      continue;
+
+    float error = ref[i] - fdb[i];
+
+    // 积分分离
+    float integral = integral_[i];
+    if (fabsf(error) < separation_[i])
+      integral += (error + last_error_[i]) * half_T_;
+
+    float limited = integral;
+    if (limited > integral_limit_[i])
+      limited = integral_limit_[i];
+    else if (limited < -integral_limit_[i])
+      limited = -integral_limit_[i];
+    integral_[i] = limited;
+
+    // 微分先行，对测量值微分
+    float output = kp_[i] * error + ki_[i] * integral + kd_T_[i] * (last_fdb_[i] - fdb[i]);
+
+    last_error_[i] = error;
+    last_fdb_[i] = fdb[i];
+
+    if (output > output_limit_[i])
+      output = output_limit_[i];
+    else if (output < -output_limit_[i])
+      output = -output_limit_[i];
+    out[i] = output;
+  }
+}
+
+#endif
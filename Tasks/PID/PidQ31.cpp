@@ -0,0 +1,109 @@
+#include "PidQ31.hpp"
+#include "math.h"
+
+static inline int32_t PidQ31_Sat(int64_t x)
+{
+  if (x > INT32_MAX) return INT32_MAX;
+  if (x < INT32_MIN) return INT32_MIN;
+  return static_cast<int32_t>(x);
+}
+
+static inline int32_t PidQ31_Add(int32_t a, int32_t b)
+{
+#if defined(__ARM_FEATURE_DSP) && __ARM_FEATURE_DSP
+  return __QADD(a, b);
+#else
+  return PidQ31_Sat(static_cast<int64_t>(a) + b);
+#endif
+}
+
+static inline int16_t PidQ31_ToInt16(int32_t q31)
+{
+#if defined(__ARM_FEATURE_DSP) && __ARM_FEATURE_DSP
+  return static_cast<int16_t>(__SSAT(q31 >> 16, 16));
+#else
+  return static_cast<int16_t>(q31 >> 16);   // Q31右移16位一定在int16范围内
+#endif
+}
+
+/*系数乘以误差，SMULL得到64位结果后右移并饱和*/
+static inline int32_t PidQ31_Mul(const PidQ31Coeff &c, int32_t x)
+{
+  return PidQ31_Sat((static_cast<int64_t>(c.mul) * x) >> c.shift);
+}
+
+/*把浮点系数(Q31每原始单位)换算成mul*2^-shift，mul尽量占满31位*/
+static PidQ31Coeff PidQ31_Coeff(float value)
+{
+  PidQ31Coeff c = {0, 0};
+  float mag = fabsf(value);
+  if (mag == 0)
+    return c;
+  while (c.shift < 62 && mag * 2.0f < 1073741824.0f) {   // 2^30
+    mag *= 2.0f;
+    c.shift++;
+  }
+  if (mag > 2147483520.0f)   // 系数本身超出范围，饱和
+    mag = 2147483520.0f;
+  c.mul = static_cast<int32_t>(lrintf(value < 0 ? -mag : mag));
+  return c;
+}
+
+/**
+ * @brief   换算定点系数，清除状态
+ * @param   params为浮点PID参数，输出单位与cmd_per_unit对应
+ * @param   T为采样周期(s)
+ * @retval  None
+ */
+void PidQ31::setParams(const PidParams &params, float T)
+{
+  const float q31_per_cmd = 65536.0f;               // int16指令1个单位对应的Q31数
+  const float scale = cmd_per_unit_ * q31_per_cmd;  // 浮点输出1个单位对应的Q31数
+
+  kp_ = PidQ31_Coeff(params.kp * scale);
+  ki_T_half_ = PidQ31_Coeff(params.ki * T * 0.5f * scale);
+  kd_T_ = PidQ31_Coeff(params.kd / T * scale);
+
+  float limit = params.ki * params.integral_limit * scale;
+  integral_limit_ = limit >= 2147483520.0f ? INT32_MAX : static_cast<int32_t>(limit);
+  float out = params.output_limit * cmd_per_unit_;
+  output_limit_ = out >= 32767.0f ? 32767 : static_cast<int16_t>(out);
+  separation_ = params.separation > 0 && params.separation < 65536.0f ? static_cast<int32_t>(ceilf(params.separation))
+                                                                    : 65536;   // 误差最大65535，不分离
+  reset();
+}
+
+/**
+ * @brief   计算一次
+ * @param   ref、fdb为原始单位的参考值和反馈值
+ * @retval  int16指令
+ */
+int16_t PidQ31::pidCalc(const int16_t ref, const int16_t fdb)
+{
+  int32_t error = static_cast<int32_t>(ref) - fdb;
+
+  // 积分分离
+  int32_t integral = integral_;
+  if (error < separation_ && error > -separation_)
+    integral = PidQ31_Add(integral, PidQ31_Mul(ki_T_half_, error + last_error_));
+
+  integral_ = integral;
+  if (integral_ > integral_limit_)
+    integral_ = integral_limit_;
+  else if (integral_ < -integral_limit_)
+    integral_ = -integral_limit_;
+
+  // 微分先行，对测量值微分
+  int32_t output = PidQ31_Add(PidQ31_Mul(kp_, error), integral);
+  output = PidQ31_Add(output, PidQ31_Mul(kd_T_, last_fdb_ - fdb));
+
+  last_error_ = error;
+  last_fdb_ = fdb;
+
+  int16_t cmd = PidQ31_ToInt16(output);
+  if (cmd > output_limit_)
+    cmd = output_limit_;
+  else if (cmd < -output_limit_)
+    cmd = -output_limit_;
+  return cmd;
+}
@@ -0,0 +1,39 @@
+#ifndef _PID_Q31_H_
+#define _PID_Q31_H_
+
+#include "PID.hpp"
+
+/*
+ * 定点PID：输入为电机反馈的原始单位(GM6020速度为rpm)，直接输出int16电流指令
+ * 各项和积分器都是Q31，表示满量程指令(±32768)的比例，输出取高16位即为int16指令
+ * 系数在setParams时由浮点参数换算成 mul * 2^-shift 的形式，每个系数单独选shift保留精度
+ * 有DSP扩展时用QADD、SSAT做饱和运算，主机上编译时用C++实现
+ * 采样周期固定，在setParams时给出；与Pid相比只有定点量化误差
+ * 抗积分饱和只支持积分限幅(kPidWindupClamp)，不支持二自由度权重和微分滤波
+ */
+struct PidQ31Coeff {
+  int32_t mul;
+  uint8_t shift;
+};
+
+class PidQ31 {
+  public:
+    PidQ31(const PidParams &params, float T, float cmd_per_unit) { cmd_per_unit_ = cmd_per_unit; setParams(params, T); };
+    ~PidQ31() = default;
+    void setParams(const PidParams &params, float T);
+    void reset(void){ integral_ = last_error_ = last_fdb_ = 0; };
+    int16_t pidCalc(const int16_t ref, const int16_t fdb);
+  private:
+    float cmd_per_unit_;      /*浮点输出1个单位对应的int16指令数，GM6020为16384/3*/
+    PidQ31Coeff kp_;
+    PidQ31Coeff ki_T_half_;   /*ki*T/2*/
+    PidQ31Coeff kd_T_;        /*kd/T*/
+    int32_t integral_limit_;  /*ki*integral_limit，Q31*/
+    int16_t output_limit_;
+    int32_t separation_;      /*积分分离阈值，原始单位*/
+    int32_t integral_;        /*ki*积分，Q31*/
+    int32_t last_error_;
+    int32_t last_fdb_;
+};
+
+#endif
@@ -0,0 +1,82 @@
+#include "PidStore.hpp"
+#include "math.h"
+
+/**
+ * @brief   写入一组新参数，在下一次commit()时生效
+ * @param   params为新参数
+ * @retval  上一组参数还没换入时返回false
+ */
+bool PidStore::stage(const PidParams &params)
+{
+  if (pending_.load(std::memory_order_acquire))
+    return false;
+  buffers_[active_ ^ 1] = params;
+  pending_.store(1, std::memory_order_release);   // 参数写完后才置位，控制上下文看到标志时数据已完整
+  return true;
+}
+
+/**
+ * @brief   换回上一组参数，在下一次commit()时生效
+ * @retval  还没有换入过参数或有参数等待换入时返回false
+ */
+bool PidStore::rollback(void)
+{
+  if (version_ == 0 || pending_.load(std::memory_order_acquire))
+    return false;
+  pending_.store(1, std::memory_order_release);   // 备用缓冲区里就是上一组参数
+  return true;
+}
+
+/**
+ * @brief   在控制周期开始时调用，把等待中的参数换入Pid
+ * @retval  本次换入了新参数时返回true
+ * @note    必须在运行pidCalc的上下文中调用
+ */
+bool PidStore::commit(void)
+{
+  if (!pending_.load(std::memory_order_acquire))
+    return false;
+  active_ ^= 1;
+  pid_.transferParams(buffers_[active_]);   // 无扰切换，换参数时输出不跳变
+  version_++;
+  pending_.store(0, std::memory_order_release);
+  return true;
+}
+
+/**
+ * @brief   把参数中的增益和限幅写入传输记录
+ * @param   params为要发送的参数，record为输出
+ * @retval  None
+ */
+void PidGains_Pack(const PidParams &params, PidGainsRecord *record)
+{
+  record->version = kPidGainsVersion;
+  record->kp = params.kp;
+  record->ki = params.ki;
+  record->kd = params.kd;
+  record->integral_limit = params.integral_limit;
+  record->output_limit = params.output_limit;
+}
+
+/**
+ * @brief   用收到的记录更新参数中的增益和限幅，其它参数不变
+ * @param   record为收到的记录，params为要更新的参数
+ * @retval  版本不符、数值不是有限值或限幅为负时返回false，params不变
+ */
+bool PidGains_Unpack(const PidGainsRecord &record, PidParams *params)
+{
+  float kp = record.kp, ki = record.ki, kd = record.kd;
+  float integral_limit = record.integral_limit, output_limit = record.output_limit;
+  if (record.version != kPidGainsVersion)
+    return false;
+  if (!isfinite(kp) || !isfinite(ki) || !isfinite(kd) || !isfinite(integral_limit) || !isfinite(output_limit))
+    return false;
+  if (integral_limit < 0 || output_limit < 0)
+    return false;
+  params->kp = kp;
+  params->ki = ki;
+  params->kd = kd;
+  params->integral_limit = integral_limit;
+  params->output_limit = output_limit;
+  return true;
+}
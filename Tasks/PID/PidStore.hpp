@@ -0,0 +1,53 @@
+#ifndef _PID_STORE_H_
+#define _PID_STORE_H_
+
+#include "PID.hpp"
+#include <atomic>
+
+/*
+ * PID参数双缓冲：低优先级的上下文(如PendSV中的后台任务)把新参数写进备用缓冲区，
+ * 控制周期开始时由控制上下文调用commit()，在周期边界整组换入Pid，控制环不会读到写了一半的参数，
+ * 换入用Pid::transferParams，输出不跳变
+ * 换入后备用缓冲区里留着上一组参数，rollback()直接把它换回来
+ * 只允许一个写入方；上一组还没换入时stage()返回false
+ */
+class PidStore {
+  public:
+    PidStore(Pid &pid) : pid_(pid) { buffers_[0] = buffers_[1] = pid.getParams();
+                                     active_ = 0; version_ = 0; pending_.store(0); };
+    ~PidStore() = default;
+    bool stage(const PidParams &params);
+    bool rollback(void);
+    bool commit(void);
+    const PidParams &active(void){ return buffers_[active_]; };
+    uint32_t version(void){ return version_; };
+    bool pending(void){ return pending_.load(std::memory_order_acquire) != 0; };
+  private:
+    Pid &pid_;
+    PidParams buffers_[2];
+    uint8_t active_;                /*Pid当前使用的缓冲区，只由commit()修改*/
+    uint32_t version_;              /*每次换入加1*/
+    std::atomic<uint8_t> pending_;  /*备用缓冲区已写好，等待换入*/
+};
+
+/*
+ * 在板间链路、串口上传输的增益记录：只有增益和限幅，按字节紧凑排列，与PidParams的内存布局无关
+ * 记录格式变化时增加kPidGainsVersion，接收方拒绝版本不同的记录
+ * 没有下发的参数(积分分离、抗饱和策略、二自由度权重、微分滤波)保持接收方当前的值
+ */
+static const uint8_t kPidGainsVersion = 1;
+
+struct __attribute__((packed)) PidGainsRecord {
+  uint8_t version;
+  float kp;
+  float ki;
+  float kd;
+  float integral_limit;
+  float output_limit;
+};
+static_assert(sizeof(PidGainsRecord) == 21, "PidGainsRecord must stay packed");
+
+void PidGains_Pack(const PidParams &params, PidGainsRecord *record);
+bool PidGains_Unpack(const PidGainsRecord &record, PidParams *params);
+
+#endif
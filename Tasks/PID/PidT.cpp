@@ -0,0 +1,5 @@
+#include "PidT.hpp"
+
+/*运行时增益的常用配置；常量增益的PidT没有setParams，由使用处隐式实例化*/
+template class PidT<kPidPID, kPidClampBoth>;
+template class PidT<kPidPI, kPidClampBoth>;
@@ -0,0 +1,129 @@
+#ifndef _PID_T_H_
+#define _PID_T_H_
+
+#include "PID.hpp"
+#include <stdint.h>
+#include <type_traits>
+#include "math.h"
+
+/*
+ * 编译期裁剪的PID：启用的项、限幅方式和积分分离阈值都是模板参数，
+ * 没有启用的项和限幅在编译期被if constexpr去掉；
+ * 增益可以是运行时可调的PidRuntimeGains，也可以是PidConstGains<...>，
+ * 后者的增益是常量，乘法直接折叠成立即数
+ * PidT<kPidPID, kPidClampBoth>与Pid的计算结果相同
+ */
+enum PidTerms : uint8_t {
+  kPidP = 1,
+  kPidI = 2,
+  kPidD = 4,
+  kPidPI = kPidP | kPidI,
+  kPidPD = kPidP | kPidD,
+  kPidPID = kPidP | kPidI | kPidD,
+};
+
+enum PidClamp : uint8_t {
+  kPidClampNone = 0,
+  kPidClampIntegral = 1,
+  kPidClampOutput = 2,
+  kPidClampBoth = kPidClampIntegral | kPidClampOutput,
+};
+
+struct PidRuntimeGains {
+  float kp;
+  float ki;
+  float kd;
+  float integral_limit;
+  float output_limit;
+};
+
+template <float Kp, float Ki, float Kd, float IntegralLimit, float OutputLimit>
+struct PidConstGains {
+  static constexpr float kp = Kp;
+  static constexpr float ki = Ki;
+  static constexpr float kd = Kd;
+  static constexpr float integral_limit = IntegralLimit;
+  static constexpr float output_limit = OutputLimit;
+};
+
+template <uint8_t Terms, uint8_t Clamp, typename Gains = PidRuntimeGains, float Separation = 35.0f>
+class PidT {
+  public:
+    static constexpr bool kUseP = (Terms & kPidP) != 0;
+    static constexpr bool kUseI = (Terms & kPidI) != 0;
+    static constexpr bool kUseD = (Terms & kPidD) != 0;
+    static constexpr bool kRuntimeGains = std::is_same_v<Gains, PidRuntimeGains>;
+
+    PidT() { integral_ = last_error_ = last_fdb_ = 0; T_ = 0; half_T_ = kd_T_ = 0; };
+    ~PidT() = default;
+
+    /*仅运行时增益可用*/
+    void setParams(const PidParams &params)
+    {
+      static_assert(kRuntimeGains, "gains of this PidT are compile-time constants");
+      gains_ = {params.kp, params.ki, params.kd, params.integral_limit, params.output_limit};
+      T_ = 0;
+    };
+
+    float pidCalc(const float ref, const float fdb, const float T)
+    {
+      if (T != T_) {
+        T_ = T;
+        half_T_ = T * 0.5f;
+        if constexpr (kUseD)
+          kd_T_ = gains_.kd / T;
+      }
+
+      float error = ref - fdb;
+      float output = 0;
+      if constexpr (kUseP)
+        output += gains_.kp * error;
+
+      if constexpr (kUseI) {
+        float integral = integral_;
+        if constexpr (Separation > 0) {   // 积分分离
+          if (fabsf(error) < Separation)
+            integral += (error + last_error_) * half_T_;
+        } else {
+          integral += (error + last_error_) * half_T_;
+        }
+        integral_ = integral;
+        if constexpr ((Clamp & kPidClampIntegral) != 0) {
+          if (integral_ > gains_.integral_limit)
+            integral_ = gains_.integral_limit;
+          else if (integral_ < -gains_.integral_limit)
+            integral_ = -gains_.integral_limit;
+        }
+        output += gains_.ki * integral;
+        last_error_ = error;
+      }
+
+      if constexpr (kUseD) {   // 微分先行，对测量值微分
+        output += kd_T_ * (last_fdb_ - fdb);
+        last_fdb_ = fdb;
+      }
+
+      if constexpr ((Clamp & kPidClampOutput) != 0) {
+        if (output > gains_.output_limit)
+          output = gains_.output_limit;
+        else if (output < -gains_.output_limit)
+          output = -gains_.output_limit;
+      }
+      return output;
+    };
+
+  private:
+    [[no_unique_address]] Gains gains_{};
+    float integral_;
+    float last_error_;
+    float last_fdb_;
+    float T_;
+    float half_T_;
+    float kd_T_;
+};
+
+/*常用配置在PidT.cpp中显式实例化，保证模板随固件一起编译*/
+extern template class PidT<kPidPID, kPidClampBoth>;
+extern template class PidT<kPidPI, kPidClampBoth>;
+
+#endif
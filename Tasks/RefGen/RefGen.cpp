@@ -0,0 +1,160 @@
+#include "RefGen.hpp"
+
+static constexpr uint16_t kRefSineSize = 1u << kRefSineBits;
+
+/*编译期计算正弦表，泰勒展开到误差远小于float精度*/
+static constexpr double RefGen_ConstSin(double x)
+{
+  const double pi = 3.14159265358979323846;
+  while (x > pi) x -= 2 * pi;
+  while (x < -pi) x += 2 * pi;
+  double term = x, sum = x;
+  for (int k = 1; k < 15; k++) {
+    term *= -x * x / ((2 * k) * (2 * k + 1));
+    sum += term;
+  }
+  return sum;
+}
+
+struct RefSineTable {
+  float v[kRefSineSize + 1];   // 多一点，插值时不用回绕
+};
+
+static constexpr RefSineTable RefGen_BuildSine(void)
+{
+  RefSineTable t{};
+  for (int i = 0; i <= kRefSineSize; i++)
+    t.v[i] = static_cast<float>(RefGen_ConstSin(2 * 3.14159265358979323846 * i / kRefSineSize));
+  return t;
+}
+
+static constexpr RefSineTable kRefSineTable = RefGen_BuildSine();
+
+float RefGen_Sin(uint64_t phase)
+{
+  uint32_t index = static_cast<uint32_t>(phase >> (64 - kRefSineBits));
+  // 表内位置取相位接下来的24位，足够float插值
+  float frac = static_cast<uint32_t>(phase >> (40 - kRefSineBits)) & 0xFFFFFFu;
+  frac *= 1.0f / 16777216.0f;
+  float a = kRefSineTable.v[index];
+  return a + frac * (kRefSineTable.v[index + 1] - a);
+}
+
+/**
+ * @brief   频率换算成64位相位增量freq*T*2^64，只在设置波形时调用，用double保证长时间运行的频率精度
+ * @param   freq为频率(Hz)，inc为输出
+ * @retval  freq*T不在(0, 0.5)内时返回false，inc不变
+ * @note    增量小于2^63，两个增量之差可以按有符号数解释
+ */
+bool RefGen::increment(float freq, uint64_t *inc)
+{
+  double turns = static_cast<double>(freq) * T_;   // 每个采样走过的周数
+  if (!(turns > 0 && turns < 0.5))
+    return false;
+  // 拆成高32位和低32位分别换算
+  double hi = turns * 4294967296.0;
+  uint32_t ihi = static_cast<uint32_t>(hi);
+  uint32_t ilo = static_cast<uint32_t>((hi - ihi) * 4294967296.0);
+  *inc = (static_cast<uint64_t>(ihi) << 32) | ilo;
+  return true;
+}
+
+bool RefGen::setSine(float amplitude, float freq, float offset)
+{
+  uint64_t inc;
+  if (!increment(freq, &inc))
+    return false;
+  wave_ = kRefSine;
+  amplitude_ = amplitude;
+  offset_ = offset;
+  inc_ = inc;
+  inc_step_ = 0;
+  period_ = 0;
+  return true;
+}
+
+bool RefGen::setSquare(float amplitude, float freq, float offset)
+{
+  if (!setSine(amplitude, freq, offset))
+    return false;
+  wave_ = kRefSquare;
+  return true;
+}
+
+bool RefGen::setTriangle(float amplitude, float freq, float offset)
+{
+  if (!setSine(amplitude, freq, offset))
+    return false;
+  wave_ = kRefTriangle;
+  return true;
+}
+
+/**
+ * @brief   线性扫频
+ * @param   f0、f1为起止频率(Hz)，f1 < f0时向下扫频
+ * @param   duration为一次扫频的时间(s)
+ * @retval  频率不合法时返回false，波形不变
+ */
+bool RefGen::setChirp(float amplitude, float f0, float f1, float duration, float offset)
+{
+  uint64_t inc0, inc1;
+  if (!increment(f0, &inc0) || !increment(f1, &inc1))
+    return false;
+  wave_ = kRefChirp;
+  amplitude_ = amplitude;
+  offset_ = offset;
+  period_ = static_cast<uint32_t>(duration / T_);
+  if (period_ == 0)
+    period_ = 1;
+  inc_ = inc0;
+  // 两个增量都小于2^63，差按有符号数相除，结果按补码存放，相位计算中的乘加自然回绕
+  inc_step_ = static_cast<uint64_t>(static_cast<int64_t>(inc1 - inc0) / static_cast<int64_t>(period_));
+  return true;
+}
+
+/**
+ * @brief   阶跃
+ * @param   delay为阶跃发生的采样序号
+ */
+void RefGen::setStep(float amplitude, uint32_t delay, float offset)
+{
+  wave_ = kRefStep;
+  amplitude_ = amplitude;
+  offset_ = offset;
+  inc_ = inc_step_ = 0;
+  period_ = delay;
+}
+
+/**
+ * @brief   第n个采样的值
+ * @param   n为采样序号
+ * @retval  参考值
+ */
+float RefGen::sample(uint32_t n)
+{
+  uint64_t phase = inc_ * n;
+  switch (wave_) {
+    case kRefSine:
+      return offset_ + amplitude_ * RefGen_Sin(phase);
+
+    case kRefSquare:
+      return offset_ + ((phase >> 63) ? -amplitude_ : amplitude_);
+
+    case kRefTriangle: {
+      float x = static_cast<uint32_t>(phase >> 32) * (1.0f / 4294967296.0f);   // 一周内的位置[0, 1)
+      float tri = x < 0.25f ? 4 * x : (x < 0.75f ? 2 - 4 * x : 4 * x - 4);
+      return offset_ + amplitude_ * tri;
+    }
+
+    case kRefChirp: {
+      // 相位 = inc0*m + step*m*(m-1)/2，m为本次扫频内的采样序号
+      uint64_t m = n % period_;
+      phase = inc_ * m + inc_step_ * (m * (m - 1) / 2);
+      return offset_ + amplitude_ * RefGen_Sin(phase);
+    }
+
+    case kRefStep:
+    default:
+      return offset_ + (n >= period_ ? amplitude_ : 0);
+  }
+}
@@ -0,0 +1,51 @@
+#ifndef _REF_GEN_H_
+#define _REF_GEN_H_
+
+#include <stdint.h>
+
+/*
+ * 参考信号发生器(DDS)：相位是64位定点数，满量程2^64为一周，第n个采样的相位 = 相位增量 * n，
+ * 整数乘法自然回绕，精度不随n增大而下降
+ * 正弦由256点表线性插值得到，最大误差约7.6e-5(相对幅值)；每个采样的计算量固定，没有double运算，
+ * 只有设置波形时用double换算相位增量
+ * sample(n)直接算第n个采样，可以用tick作为n，调用不规律也不会累积误差；next()按顺序输出
+ * 频率必须满足0 < freq*T < 0.5(低于奈奎斯特频率)，否则设置函数返回false，波形保持不变
+ */
+enum RefWave : uint8_t {
+  kRefSine = 0,
+  kRefSquare,
+  kRefTriangle,
+  kRefChirp,      // 线性扫频，从f0扫到f1后重新开始，f1可以低于f0
+  kRefStep,
+};
+
+static const uint8_t kRefSineBits = 8;   // 正弦表256点
+
+class RefGen {
+  public:
+    RefGen(float T) { T_ = T; n_ = 0; setStep(0, 0); };
+    ~RefGen() = default;
+    bool setSine(float amplitude, float freq, float offset = 0);
+    bool setSquare(float amplitude, float freq, float offset = 0);
+    bool setTriangle(float amplitude, float freq, float offset = 0);
+    bool setChirp(float amplitude, float f0, float f1, float duration, float offset = 0);
+    void setStep(float amplitude, uint32_t delay, float offset = 0);
+    float sample(uint32_t n);
+    float next(void){ return sample(n_++); };
+    void reset(void){ n_ = 0; };
+  private:
+    bool increment(float freq, uint64_t *inc);
+    RefWave wave_;
+    float T_;
+    float amplitude_;
+    float offset_;
+    uint64_t inc_;        /*每个采样的相位增量，扫频时为起始频率的增量*/
+    uint64_t inc_step_;   /*扫频时相位增量每个采样的增加量，按补码表示，向下扫频时为负*/
+    uint32_t period_;     /*扫频一次的采样数；阶跃的延迟*/
+    uint32_t n_;
+};
+
+/*sin(2*pi*phase/2^64)，phase为64位定点相位*/
+float RefGen_Sin(uint64_t phase);
+
+#endif
@@ -0,0 +1,119 @@
+#include "SCurve.hpp"
+#include "math.h"
+
+/**
+ * @brief   把状态设为静止在pos，目标也设为pos
+ * @param   pos为当前位置
+ * @retval  None
+ */
+void SCurve::reset(float pos)
+{
+  pos_ = target_ = pos;
+  vel_ = acc_ = 0;
+}
+
+/*
+ * 从速度v(≥0)、加速度a开始按jerk受限的方式尽快刹车，返回速度到0之前走过的距离
+ * 刹车分三段：以-j把加速度降到-peak，保持-peak，再以+j回到0，速度和加速度同时到0
+ */
+float SCurve::stopDistance(float v, float a)
+{
+  const float j = limits_.j_max;
+  const float a_max = limits_.a_max;
+
+  float need = j * v + a * a * 0.5f;   // 三角形刹车时peak^2
+  if (a < 0 && need < a * a) {
+    // 减速度已经偏大，加速度以+j升回0之前速度就会到0，算到速度为0的那一刻
+    float t = (-a - sqrtf(a * a - 2 * j * v)) / j;
+    return v * t + a * t * t * 0.5f + j * t * t * t / 6;
+  }
+
+  float ap = sqrtf(need);
+  float t2 = 0;
+  if (ap > a_max) {
+    ap = a_max;
+    t2 = (v + a * a / (2 * j) - a_max * a_max / j) / a_max;
+  }
+
+  float t1 = (a + ap) / j;
+  float t3 = ap / j;
+  float d1 = v * t1 + a * t1 * t1 * 0.5f - j * t1 * t1 * t1 / 6;
+  float v1 = v + a * t1 - j * t1 * t1 * 0.5f;
+  float d2 = v1 * t2 - ap * t2 * t2 * 0.5f;
+  float v2 = v1 - ap * t2;
+  float d3 = v2 * t3 - ap * t3 * t3 * 0.5f + j * t3 * t3 * t3 / 6;
+  return d1 + d2 + d3;
+}
+
+/*以加速度a走一步(a_next为这一步结束时的加速度)之后再全力刹车，是否会冲过dist*/
+bool SCurve::fits(float v, float a, float a_next, float dist)
+{
+  float v_next = v + (a + a_next) * 0.5f * T_;
+  float step = (v + v_next) * 0.5f * T_;
+  if (v_next <= 0)
+    return step <= dist;
+  return step + stopDistance(v_next, a_next) <= dist;
+}
+
+/**
+ * @brief   运行一个tick
+ * @retval  None
+ * @note    在jerk允许的范围内，选满足"走完这一步再全力刹车也不会冲过目标"的最大加速度，
+ *          刹车距离对加速度单调，用固定次数的二分查找，计算量固定
+ */
+void SCurve::update(void)
+{
+  const float j = limits_.j_max;
+  const float a_max = limits_.a_max;
+  const float jT = j * T_;
+  float error = target_ - pos_;
+  float dir = error >= 0 ? 1.0f : -1.0f;
+
+  // 以目标方向为正
+  float dist = error * dir;
+  float v = vel_ * dir;
+  float a = acc_ * dir;
+
+  // 已经很近且几乎静止，直接到位；阈值不小于target_的浮点精度，否则远离0的目标永远到不了
+  float eps = jT * T_ * T_ + fabsf(target_) * 1e-6f;
+  if (dist < eps && fabsf(v) * T_ < eps && fabsf(a) < jT) {
+    reset(target_);
+    return;
+  }
+
+  // 不考虑目标时：jerk受限地追最大速度，在v_max处刚好把加速度降到0
+  float dv = limits_.v_max - v - a * T_;
+  float hi = sqrtf(2 * j * fabsf(dv));
+  if (hi > a_max)
+    hi = a_max;
+  if (dv < 0)
+    hi = -hi;
+  if (hi > a + jT)
+    hi = a + jT;
+  else if (hi < a - jT)
+    hi = a - jT;
+
+  float lo = a - jT;
+  if (lo < -a_max)
+    lo = -a_max;
+  if (hi < lo)
+    hi = lo;
+
+  float a_next = hi;
+  if (!fits(v, a, hi, dist)) {
+    // 全力刹车也来不及时取lo，否则二分找刚好不冲过目标的加速度
+    for (int i = 0; i < 12 && fits(v, a, lo, dist); i++) {
+      float mid = (lo + hi) * 0.5f;
+      if (fits(v, a, mid, dist))
+        lo = mid;
+      else
+        hi = mid;
+    }
+    a_next = lo;
+  }
+
+  float v_next = v + (a + a_next) * 0.5f * T_;
+  pos_ += dir * (v + v_next) * 0.5f * T_;
+  vel_ = dir * v_next;
+  acc_ = dir * a_next;
+}
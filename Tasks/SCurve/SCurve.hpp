@@ -0,0 +1,44 @@
+#ifndef _S_CURVE_H_
+#define _S_CURVE_H_
+
+#include <stdint.h>
+
+/*
+ * 在线S曲线轨迹规划：速度、加速度、加加速度(jerk)都受限，每个tick输出位置、速度、加速度参考值
+ * 每个tick在jerk允许的范围内选最大的加速度，保证走完这一步再全力刹车也不会冲过目标，
+ * 刹车距离有闭式解，计算量固定，随时可以setTarget改变目标，从当前的位置、速度、加速度平滑地转向新目标
+ * acc()可以乘以惯量/力矩常数作为电流前馈，与位置、速度环的输出叠加后交给GM6020::setInput
+ */
+struct SCurveLimits {
+  float v_max;   // 最大速度
+  float a_max;   // 最大加速度
+  float j_max;   // 最大加加速度
+};
+
+class SCurve {
+  public:
+    SCurve(float T, const SCurveLimits &limits) { T_ = T; limits_ = limits; reset(0); };
+    ~SCurve() = default;
+    void setLimits(const SCurveLimits &limits){ limits_ = limits; };
+    void reset(float pos);
+    void setTarget(float target){ target_ = target; };
+    void update(void);
+    float pos(void){ return pos_; };
+    float vel(void){ return vel_; };
+    float acc(void){ return acc_; };
+    float target(void){ return target_; };
+    bool done(void){ return pos_ == target_ && vel_ == 0 && acc_ == 0; };
+    /*加速度前馈，k为惯量与力矩常数之比(A/(单位/s^2))*/
+    float feedForward(float k){ return k * acc_; };
+  private:
+    float stopDistance(float v, float a);
+    bool fits(float v, float a, float a_next, float dist);
+    float T_;
+    SCurveLimits limits_;
+    float target_;
+    float pos_;
+    float vel_;
+    float acc_;
+};
+
+#endif
@@ -0,0 +1,122 @@
+#include "Scheduler.hpp"
+#include "Dwt.hpp"
+#include <atomic>
+
+struct SchedTask {
+  void (*fn)(void);
+  uint16_t period;
+  uint16_t phase;
+  uint8_t priority;
+  SchedContext context;
+  uint32_t budget;       // 超过这个周期数算超时，只用于ISR任务
+  SchedTaskStats stats;
+};
+
+static SchedTask sched_tasks[kSchedMaxTasks];
+static uint8_t sched_count;
+static uint8_t sched_order[kSchedMaxTasks];       // 按priority排好的任务下标
+static std::atomic<uint32_t> sched_pending;       // 已释放还没运行完的PendSV任务，按sched_order的位置编号
+
+/**
+ * @brief   注册一个周期任务
+ * @param   fn为任务函数
+ * @param   period为周期(tick)，phase为相位(tick)，phase < period
+ * @param   priority越小越先运行
+ * @param   context为运行的上下文
+ * @retval  任务编号，任务已满或参数不合法时返回-1
+ */
+int8_t Sched_Register(void (*fn)(void), uint16_t period, uint16_t phase, uint8_t priority, SchedContext context)
+{
+  if (sched_count >= kSchedMaxTasks || fn == nullptr || period == 0 || phase >= period)
+    return -1;
+
+  int8_t index = sched_count;
+  SchedTask &t = sched_tasks[index];
+  t.fn = fn;
+  t.period = period;
+  t.phase = phase;
+  t.priority = priority;
+  t.context = context;
+  t.stats = {0, 0, 0, 0};
+
+  // 插入排序，priority相同时先注册的在前
+  uint8_t pos = sched_count;
+  while (pos > 0 && sched_tasks[sched_order[pos - 1]].priority > priority) {
+    sched_order[pos] = sched_order[pos - 1];
+    pos--;
+  }
+  sched_order[pos] = index;
+  sched_count++;
+  return index;
+}
+
+/**
+ * @brief   计算ISR任务的超时阈值，在启动TIM6之前调用
+ * @param   cycles_per_tick为一个tick的CPU周期数
+ * @retval  None
+ */
+void Sched_Start(uint32_t cycles_per_tick)
+{
+  for (uint8_t i = 0; i < sched_count; i++)
+    sched_tasks[i].budget = sched_tasks[i].period * cycles_per_tick;
+  sched_pending.store(0);
+}
+
+static void Sched_Run(SchedTask &t)
+{
+  uint32_t start = Dwt_Cycles();
+  t.fn();
+  uint32_t cycles = Dwt_Cycles() - start;
+  t.stats.runs++;
+  t.stats.cycles = cycles;
+  if (cycles > t.stats.cycles_max)
+    t.stats.cycles_max = cycles;
+}
+
+/**
+ * @brief   在TIM6中断中调用，释放到期的任务
+ * @param   tick为当前tick
+ * @retval  None
+ */
+void Sched_Tick(uint32_t tick)
+{
+  bool pend = false;
+  for (uint8_t i = 0; i < sched_count; i++) {
+    SchedTask &t = sched_tasks[sched_order[i]];
+    if ((tick - t.phase) % t.period != 0)
+      continue;
+
+    if (t.context == kSchedIsr) {
+      Sched_Run(t);
+      if (t.stats.cycles > t.budget)
+        t.stats.overruns++;
+    } else if (sched_pending.fetch_or(1u << i) & (1u << i)) {
+      t.stats.overruns++;   // 上一次还没运行完，丢弃这次释放
+    } else {
+      pend = true;
+    }
+  }
+  if (pend)
+    SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+}
+
+/**
+ * @brief   PendSV中按priority运行已释放的任务，运行完才清除释放标志
+ * @retval  None
+ */
+extern "C" void Sched_PendSVHandler(void)
+{
+  uint32_t pending;
+  while ((pending = sched_pending.load()) != 0) {
+    uint8_t i = __builtin_ctz(pending);   // 最低位就是priority最高的
+    Sched_Run(sched_tasks[sched_order[i]]);
+    sched_pending.fetch_and(~(1u << i));
+  }
+}
+
+const SchedTaskStats *Sched_GetStats(int8_t task)
+{
+  if (task < 0 || task >= sched_count)
+    return nullptr;
+  return &sched_tasks[task].stats;
+}
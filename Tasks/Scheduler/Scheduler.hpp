@@ -0,0 +1,40 @@
+#ifndef _SCHEDULER_H_
+#define _SCHEDULER_H_
+
+#include "main.h"
+
+/*
+ * 静态周期任务调度，由TIM6中断按tick驱动
+ * 任务按周期(tick)和相位注册，在(tick - phase)为周期整数倍时释放：
+ *   kSchedIsr     在TIM6中断里直接运行，用于控制环等对抖动敏感的短任务
+ *   kSchedPendSV  挂起PendSV，在最低优先级的PendSV中运行，可以被除SysTick以外的中断抢占；
+ *                 SysTick与PendSV同优先级，任务中HAL_GetTick不会增加，不能调用按tick等待超时的HAL函数
+ * priority越小越先运行，按速率单调原则，周期越短的任务priority应越小
+ * PendSV任务之间不抢占，同一次PendSV里按priority依次运行全部已释放的任务
+ * 超时检测：ISR任务的运行时间超过自己的周期，或PendSV任务再次释放时上一次还没运行完，都计一次超时，
+ * 后者会丢弃这次释放
+ * 所有任务都要在Sched_Start之前注册
+ */
+static const uint8_t kSchedMaxTasks = 8;
+
+enum SchedContext : uint8_t {
+  kSchedIsr = 0,
+  kSchedPendSV,
+};
+
+struct SchedTaskStats {
+  uint32_t runs;
+  uint32_t overruns;
+  uint32_t cycles;       // 最近一次运行的CPU周期数
+  uint32_t cycles_max;
+};
+
+int8_t Sched_Register(void (*fn)(void), uint16_t period, uint16_t phase, uint8_t priority, SchedContext context);
+void Sched_Start(uint32_t cycles_per_tick);
+void Sched_Tick(uint32_t tick);
+const SchedTaskStats *Sched_GetStats(int8_t task);
+
+/*在stm32f4xx_it.c的PendSV_Handler中调用*/
+extern "C" void Sched_PendSVHandler(void);
+
+#endif
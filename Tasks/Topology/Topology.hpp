@@ -0,0 +1,265 @@
+#ifndef _TOPOLOGY_H_
+#define _TOPOLOGY_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <array>
+
+#include "BoardLink.hpp"
+
+/*
+ * 机器人总线拓扑：总线 → 设备 → 收发ID → 控制帧分组
+ * 过滤器组、接收分发表、控制帧分组和电机数组都在编译期由kTopology生成，
+ * 反馈ID重复、控制帧槽位冲突或过滤器组不够用会直接编译失败
+ */
+enum TopoBus : uint8_t {
+  kTopoCan1 = 0,
+  kTopoCan2,
+  kTopoBusNum,
+};
+
+enum TopoDeviceType : uint8_t {
+  kTopoNone = 0,
+  kTopoGM6020,
+  kTopoBoardLink,
+  kTopoCommand,     // 上位机或调试工具发来的命令帧，交给协程处理
+};
+
+#ifndef CAN_COMMAND_RX_ID
+#define CAN_COMMAND_RX_ID 0x330   /*命令帧ID，data[0]为命令码*/
+#endif
+
+struct TopoDevice {
+  uint8_t bus;
+  uint8_t type;
+  uint8_t motor_id;   // 电机拨码id
+  uint16_t rx_id;     // 反馈帧ID
+  uint16_t tx_id;     // 控制帧ID，0表示不需要发送
+  uint8_t slot;       // 在控制帧中的位置，每帧4个槽位
+};
+
+/*GM6020电流控制：id 1~4用0x1FE，id 5~7用0x2FE，反馈ID为0x204+id*/
+constexpr TopoDevice TopoGM6020(uint8_t bus, uint8_t id)
+{
+  return {bus, kTopoGM6020, id, static_cast<uint16_t>(0x204 + id),
+          static_cast<uint16_t>(id <= 4 ? 0x1FE : 0x2FE), static_cast<uint8_t>((id - 1) % 4)};
+}
+
+constexpr TopoDevice TopoBoardLink(uint8_t bus, uint16_t rx_id)
+{
+  return {bus, kTopoBoardLink, 0, rx_id, 0, 0};
+}
+
+constexpr TopoDevice TopoCommand(uint8_t bus, uint16_t rx_id)
+{
+  return {bus, kTopoCommand, 0, rx_id, 0, 0};
+}
+
+/* 拓扑描述，增删设备只需要修改这里 ------------------------------------------*/
+constexpr TopoDevice kTopology[] = {
+    TopoGM6020(kTopoCan1, 1),
+    TopoGM6020(kTopoCan1, 2),
+    TopoGM6020(kTopoCan1, 3),
+    TopoGM6020(kTopoCan1, 4),
+    TopoGM6020(kTopoCan1, 5),
+    TopoGM6020(kTopoCan1, 6),
+    TopoGM6020(kTopoCan1, 7),
+    TopoBoardLink(kTopoCan1, BOARD_LINK_RX_ID),
+    TopoCommand(kTopoCan1, CAN_COMMAND_RX_ID),
+};
+
+constexpr size_t kTopoDeviceNum = sizeof(kTopology) / sizeof(kTopology[0]);
+constexpr size_t kTopoFilterBanksPerBus = 14;   // 28个过滤器组，CAN1/CAN2各14个
+constexpr size_t kTopoCatchAllBanks = 1;        // 每条总线最后留一组接收其它ID到FIFO1，只用于统计总线负载
+constexpr size_t kTopoSlotsPerFrame = 4;
+
+/* 编译期计算 ----------------------------------------------------------------*/
+constexpr size_t TopoCount(uint8_t type)
+{
+  size_t n = 0;
+  for (const TopoDevice &d : kTopology)
+    n += (d.type == type);
+  return n;
+}
+
+constexpr size_t kTopoMotorNum = TopoCount(kTopoGM6020);
+
+/*第index个电机在拓扑中的描述，顺序即motors数组的顺序*/
+constexpr const TopoDevice &TopoMotor(size_t index)
+{
+  size_t n = 0;
+  for (const TopoDevice &d : kTopology) {
+    if (d.type == kTopoGM6020 && n++ == index)
+      return d;
+  }
+  return kTopology[0];
+}
+
+constexpr size_t TopoRxIdNum(uint8_t bus)
+{
+  size_t n = 0;
+  for (const TopoDevice &d : kTopology)
+    n += (d.bus == bus);
+  return n;
+}
+
+constexpr bool TopoRxIdsUnique(void)
+{
+  for (size_t i = 0; i < kTopoDeviceNum; i++)
+    for (size_t j = i + 1; j < kTopoDeviceNum; j++)
+      if (kTopology[i].bus == kTopology[j].bus && kTopology[i].rx_id == kTopology[j].rx_id)
+        return false;
+  return true;
+}
+
+constexpr bool TopoTxSlotsValid(void)
+{
+  for (size_t i = 0; i < kTopoDeviceNum; i++) {
+    if (kTopology[i].tx_id == 0)
+      continue;
+    if (kTopology[i].slot >= kTopoSlotsPerFrame)
+      return false;
+    for (size_t j = i + 1; j < kTopoDeviceNum; j++)
+      if (kTopology[i].bus == kTopology[j].bus && kTopology[i].tx_id == kTopology[j].tx_id &&
+          kTopology[i].slot == kTopology[j].slot)
+        return false;
+  }
+  return true;
+}
+
+static_assert(TopoRxIdsUnique(), "duplicate feedback ID on one bus");
+static_assert(TopoTxSlotsValid(), "TX group slot collision or slot out of range");
+static_assert((TopoRxIdNum(kTopoCan1) + 3) / 4 + kTopoCatchAllBanks <= kTopoFilterBanksPerBus,
+              "CAN1 filter banks exhausted");
+static_assert((TopoRxIdNum(kTopoCan2) + 3) / 4 + kTopoCatchAllBanks <= kTopoFilterBanksPerBus,
+              "CAN2 filter banks exhausted");
+
+/* 过滤器组：16位列表模式，每组4个ID，不足4个时重复最后一个 */
+struct TopoFilterBank {
+  uint16_t id[4];
+};
+
+template <uint8_t Bus>
+constexpr std::array<TopoFilterBank, (TopoRxIdNum(Bus) + 3) / 4> TopoFilterBanks(void)
+{
+  std::array<TopoFilterBank, (TopoRxIdNum(Bus) + 3) / 4> banks{};
+  size_t n = 0;
+  uint16_t last = 0;
+  for (const TopoDevice &d : kTopology) {
+    if (d.bus != Bus)
+      continue;
+    last = static_cast<uint16_t>(d.rx_id << 5);   // 标准帧ID在16位过滤器中左移5位
+    banks[n / 4].id[n % 4] = last;
+    n++;
+  }
+  for (; n % 4 != 0; n++)
+    banks[n / 4].id[n % 4] = last;
+  return banks;
+}
+
+/* 接收分发表：以该总线最小的反馈ID为基址，直接按ID下标查表 */
+struct TopoRoute {
+  uint8_t type;
+  uint8_t index;      // 电机在motors中的下标
+};
+
+constexpr uint16_t TopoRxIdMin(uint8_t bus)
+{
+  uint16_t v = 0x7FF;
+  for (const TopoDevice &d : kTopology)
+    if (d.bus == bus && d.rx_id < v)
+      v = d.rx_id;
+  return v;
+}
+
+constexpr uint16_t TopoRxIdSpan(uint8_t bus)
+{
+  uint16_t v = 0;
+  for (const TopoDevice &d : kTopology)
+    if (d.bus == bus && d.rx_id - TopoRxIdMin(bus) + 1 > v)
+      v = d.rx_id - TopoRxIdMin(bus) + 1;
+  return v;
+}
+
+template <uint8_t Bus>
+constexpr std::array<TopoRoute, TopoRxIdSpan(Bus)> TopoDispatchTable(void)
+{
+  std::array<TopoRoute, TopoRxIdSpan(Bus)> table{};
+  uint8_t motor = 0;
+  for (const TopoDevice &d : kTopology) {
+    if (d.bus == Bus)
+      table[d.rx_id - TopoRxIdMin(Bus)] = {d.type, motor};
+    motor += (d.type == kTopoGM6020);
+  }
+  return table;
+}
+
+constexpr auto kTopoDispatchCan1 = TopoDispatchTable<kTopoCan1>();
+constexpr auto kTopoDispatchCan2 = TopoDispatchTable<kTopoCan2>();
+
+/*运行时查表，O(1)*/
+static inline TopoRoute TopoDispatch(uint8_t bus, uint32_t std_id)
+{
+  if (bus == kTopoCan1) {
+    uint32_t i = std_id - TopoRxIdMin(kTopoCan1);
+    return (i < kTopoDispatchCan1.size()) ? kTopoDispatchCan1[i] : TopoRoute{kTopoNone, 0};
+  }
+  uint32_t i = std_id - TopoRxIdMin(kTopoCan2);
+  return (i < kTopoDispatchCan2.size()) ? kTopoDispatchCan2[i] : TopoRoute{kTopoNone, 0};
+}
+
+/* 控制帧分组：同一总线、同一控制帧ID的电机合成一帧发送 */
+struct TopoTxGroup {
+  uint8_t bus;
+  uint16_t tx_id;
+  uint8_t count;
+  uint8_t motors[kTopoSlotsPerFrame];   // 组内电机在motors中的下标
+};
+
+constexpr size_t TopoTxGroupNum(void)
+{
+  size_t n = 0;
+  for (size_t i = 0; i < kTopoMotorNum; i++) {
+    bool first = true;
+    for (size_t j = 0; j < i; j++)
+      if (TopoMotor(j).bus == TopoMotor(i).bus && TopoMotor(j).tx_id == TopoMotor(i).tx_id)
+        first = false;
+    n += first;
+  }
+  return n;
+}
+
+constexpr size_t kTopoTxGroupNum = TopoTxGroupNum();
+
+constexpr std::array<TopoTxGroup, kTopoTxGroupNum> TopoTxGroups(void)
+{
+  std::array<TopoTxGroup, kTopoTxGroupNum> groups{};
+  size_t n = 0;
+  for (size_t i = 0; i < kTopoMotorNum; i++) {
+    const TopoDevice &m = TopoMotor(i);
+    size_t g = 0;
+    while (g < n && !(groups[g].bus == m.bus && groups[g].tx_id == m.tx_id))
+      g++;
+    if (g == n) {
+      groups[n] = {m.bus, m.tx_id, 0, {}};
+      n++;
+    }
+    groups[g].motors[groups[g].count++] = static_cast<uint8_t>(i);
+  }
+  return groups;
+}
+
+constexpr auto kTopoTxGroups = TopoTxGroups();
+
+constexpr std::array<uint8_t, kTopoMotorNum> TopoMotorGroups(void)
+{
+  std::array<uint8_t, kTopoMotorNum> map{};
+  for (size_t g = 0; g < kTopoTxGroupNum; g++)
+    for (size_t k = 0; k < kTopoTxGroups[g].count; k++)
+      map[kTopoTxGroups[g].motors[k]] = static_cast<uint8_t>(g);
+  return map;
+}
+
+constexpr auto kTopoMotorGroup = TopoMotorGroups();   // 电机下标 → 控制帧分组
+
+#endif
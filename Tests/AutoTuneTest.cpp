@@ -0,0 +1,89 @@
+/*
+ * AutoTune的主机仿真：在一阶惯性加纯滞后的电机速度模型上做继电反馈，
+ * 与模型的理论临界增益、临界周期比较，再用整定出的增益做阶跃响应
+ */
+#include "AutoTune.hpp"
+#include "MotorModel.hpp"
+#include "Check.hpp"
+
+#include <math.h>
+
+static const float T = 0.001f;
+
+static bool RunTune(AutoTune &tune, MotorModel &motor, const AutoTuneConfig &config, float noise)
+{
+  uint32_t seed = 5;
+  tune.start(config);
+  float fdb = 0;
+  for (int i = 0; i < 100000 && tune.running(); i++) {
+    seed = seed * 1664525u + 1013904223u;
+    float n = ((seed >> 8) * (1.0f / 16777216.0f) - 0.5f) * 2.0f * noise;
+    fdb = motor.step(tune.step(fdb + n, T), T);
+  }
+  return tune.state() == kAutoTuneDone;
+}
+
+/*描述函数法只计入基波：临界周期在几个百分点内，滞后较大时临界增益偏小，整定结果偏保守*/
+static void TestCritical(void)
+{
+  MotorModel motor(200.0f, 0.05f, 10);
+  float ku, tu;
+  motor.critical(T, &ku, &tu);
+
+  AutoTune tune;
+  AutoTuneConfig config = {100.0f, 0.5f, 0.3f, 0.5f, 4, 5.0f};
+  CHECK(RunTune(tune, motor, config, 0.1f));
+  printf("AutoTune: Ku %.4f (model %.4f), Tu %.4f s (model %.4f s)\n", tune.ku(), ku, tune.tu(), tu);
+  CHECK(fabsf(tune.tu() - tu) < 0.05f * tu);
+  CHECK(tune.ku() < ku && tune.ku() > 0.75f * ku);
+}
+
+/*整定出的PI增益在同一个模型上闭环稳定，阶跃响应收敛且超调有限*/
+static void TestStepResponse(void)
+{
+  MotorModel motor(200.0f, 0.05f, 10);
+  AutoTune tune;
+  AutoTuneConfig config = {100.0f, 0.5f, 0.3f, 2.0f, 4, 5.0f};
+  CHECK(RunTune(tune, motor, config, 0));
+
+  PidParams params = {0, 0, 0, 1000.0f, 2.0f};
+  params.separation = 0;
+  Pid pid(params);
+  CHECK(tune.result(&params, kAutoTuneZieglerNicholsPI));
+  CHECK(params.separation == 0 && params.output_limit == 2.0f);   // 只改增益
+  pid.transferParams(params);
+
+  MotorModel plant(200.0f, 0.05f, 10);
+  const float ref = 150.0f;
+  float fdb = 0, peak = 0;
+  for (int i = 0; i < 3000; i++) {
+    fdb = plant.step(pid.pidCalc(ref, fdb, T), T);
+    if (fdb > peak) peak = fdb;
+  }
+  printf("AutoTune: Z-N PI step to %.0f, overshoot %.1f%%, final %.2f\n", ref, 100.0f * (peak - ref) / ref, fdb);
+  CHECK(fabsf(fdb - ref) < 0.01f * ref);
+  CHECK(peak < 1.6f * ref);
+}
+
+/*回差大于振荡幅值时继电器不再切换，超时后报告失败，输出回到bias*/
+static void TestTimeout(void)
+{
+  MotorModel motor(200.0f, 0.05f, 10);
+  AutoTune tune;
+  AutoTuneConfig config = {100.0f, 0.5f, 0.01f, 50.0f, 4, 1.0f};
+  CHECK(!RunTune(tune, motor, config, 0));
+  CHECK(tune.state() == kAutoTuneFailed);
+  CHECK(tune.step(0, T) == config.bias);
+
+  PidParams params = {1.0f, 0, 0, 10.0f, 2.0f};
+  CHECK(!tune.result(&params, kAutoTuneZieglerNichols));
+  CHECK(params.kp == 1.0f);
+}
+
+int main(void)
+{
+  TestCritical();
+  TestStepResponse();
+  TestTimeout();
+  return CHECK_RESULT();
+}
@@ -0,0 +1,34 @@
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include <chrono>
+#include <stdint.h>
+
+/*
+ * 主机基准测试：重复调用fn，返回每次调用的平均纳秒数，取rounds轮中最快的一轮
+ * 主机上的数字只用于比较同一台机器上不同实现的相对快慢，片上周期数用DWT测量
+ */
+template <typename Fn>
+double BenchNs(Fn &&fn, uint32_t calls, uint32_t rounds = 5)
+{
+  double best = 1e30;
+  for (uint32_t r = 0; r < rounds; r++) {
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < calls; i++)
+      fn(i);
+    auto stop = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(stop - start).count() / calls;
+    if (ns < best)
+      best = ns;
+  }
+  return best;
+}
+
+/*防止基准测试的结果被优化掉*/
+template <typename T>
+inline void BenchKeep(const T &value)
+{
+  asm volatile("" : : "g"(value) : "memory");
+}
+
+#endif
@@ -0,0 +1,183 @@
+/*
+ * 板间同步回环测试：发送端的分片直接交给接收端，检查字段同步、增量编码、丢包检测和字段表容量检查
+ */
+#include "BoardLink.hpp"
+#include "Check.hpp"
+
+#include <string.h>
+
+struct LinkState {
+  float gimbal_yaw;
+  float gimbal_pitch;
+  float chassis_vx;
+  float chassis_vy;
+  float chassis_wz;
+  uint8_t mode;
+};
+
+static LinkState local;
+static LinkState remote;
+static constexpr BoardLinkField local_fields[] = {
+    BOARD_LINK_FIELD(local.gimbal_yaw), BOARD_LINK_FIELD(local.gimbal_pitch),
+    BOARD_LINK_FIELD(local.chassis_vx), BOARD_LINK_FIELD(local.chassis_vy),
+    BOARD_LINK_FIELD(local.chassis_wz), BOARD_LINK_FIELD(local.mode)};
+static constexpr BoardLinkField remote_fields[] = {
+    BOARD_LINK_FIELD(remote.gimbal_yaw), BOARD_LINK_FIELD(remote.gimbal_pitch),
+    BOARD_LINK_FIELD(remote.chassis_vx), BOARD_LINK_FIELD(remote.chassis_vy),
+    BOARD_LINK_FIELD(remote.chassis_wz), BOARD_LINK_FIELD(remote.mode)};
+
+/*把当前消息的分片全部交给rx，drop为要丢弃的分片序号(-1不丢)，返回帧数*/
+static int Transfer(BoardLinkTx &tx, BoardLinkRx &rx, int drop = -1)
+{
+  uint8_t data[8];
+  uint8_t len;
+  int frames = 0;
+  while (tx.peekFrame(data, &len)) {
+    tx.popFrame();
+    if (frames != drop)
+      rx.onFrame(data, len);
+    frames++;
+  }
+  return frames;
+}
+
+static bool Same(void)
+{
+  return local.gimbal_yaw == remote.gimbal_yaw && local.gimbal_pitch == remote.gimbal_pitch &&
+         local.chassis_vx == remote.chassis_vx && local.chassis_vy == remote.chassis_vy &&
+         local.chassis_wz == remote.chassis_wz && local.mode == remote.mode;
+}
+
+static void TestSync(void)
+{
+  memset(&local, 0, sizeof(local));
+  memset(&remote, 0xFF, sizeof(remote));
+  BoardLinkTx tx(local_fields, 10);
+  BoardLinkRx rx(remote_fields);
+  CHECK(tx.ok() && rx.ok());
+
+  // 第一条消息是关键帧：1字节掩码 + 21字节数据，4个分片
+  CHECK(tx.update());
+  CHECK(Transfer(tx, rx) == 4);
+  CHECK(rx.synced());
+  CHECK(Same());
+
+  // 没有变化时不发送
+  CHECK(!tx.update());
+  CHECK(Transfer(tx, rx) == 0);
+
+  // 只改一个字段：1字节掩码 + 4字节，一帧
+  local.gimbal_yaw = 1.5f;
+  CHECK(tx.update());
+  CHECK(Transfer(tx, rx) == 1);
+  CHECK(Same());
+  CHECK(rx.messages() == 2);
+}
+
+static void TestLoss(void)
+{
+  memset(&local, 0, sizeof(local));
+  memset(&remote, 0, sizeof(remote));
+  BoardLinkTx tx(local_fields, 10);
+  BoardLinkRx rx(remote_fields);
+  tx.update();
+  Transfer(tx, rx);
+  CHECK(rx.synced());
+
+  // 丢掉两片消息的最后一片，不写回任何字段
+  local.chassis_vx = 2.0f;
+  local.chassis_vy = -3.0f;
+  local.mode = 7;
+  CHECK(tx.update());
+  CHECK(Transfer(tx, rx, 1) == 2);
+  CHECK(!Same());
+
+  // 下一条消息到达时丢弃不完整的上一条，序号不连续记为丢失，在关键帧之前保持未同步
+  local.chassis_wz = 0.5f;
+  tx.update();
+  Transfer(tx, rx);
+  CHECK(rx.dropped() == 1);
+  CHECK(rx.lost() == 1);
+  CHECK(!rx.synced());
+
+  // 关键帧到达后恢复同步，全部字段一致
+  for (int i = 0; i < 10 && !rx.synced(); i++) {
+    local.gimbal_pitch += 0.25f;
+    tx.update();
+    Transfer(tx, rx);
+  }
+  CHECK(rx.synced());
+  CHECK(Same());
+}
+
+/*发送方没有取走分片时不生成新消息；peekFrame不移动分片位置，发送失败可以重发*/
+static void TestBusy(void)
+{
+  memset(&local, 0, sizeof(local));
+  BoardLinkTx tx(local_fields, 10);
+  uint8_t a[8], b[8];
+  uint8_t la, lb;
+  tx.update();
+  CHECK(tx.peekFrame(a, &la));
+  CHECK(tx.peekFrame(b, &lb));
+  CHECK(la == lb && memcmp(a, b, la) == 0);
+  CHECK(tx.frames() == 0);
+  local.mode = 1;
+  CHECK(!tx.update());
+  CHECK(tx.busy() == 1);
+}
+
+/*放不进一条消息的字段表：收发两端都拒绝，而不是只同步其中一部分*/
+static uint8_t big[5][12];
+static constexpr BoardLinkField big_fields[] = {
+    BOARD_LINK_FIELD(big[0]), BOARD_LINK_FIELD(big[1]), BOARD_LINK_FIELD(big[2]),
+    BOARD_LINK_FIELD(big[3]), BOARD_LINK_FIELD(big[4])};
+
+static void TestCapacity(void)
+{
+  static_assert(BoardLink_MsgSize(local_fields, 6) == 22);
+  static_assert(BoardLink_Fits(local_fields, 6));
+  CHECK(!BoardLink_Fits(big_fields, 5));
+
+  BoardLinkTx tx(big_fields, 10);
+  BoardLinkRx rx(big_fields);
+  CHECK(!tx.ok() && !rx.ok());
+  CHECK(!tx.update());
+  uint8_t data[8] = {1, 0x80, 0xFF};
+  CHECK(!rx.onFrame(data, 8));
+}
+
+/*带宽：云台角度每周期都变，底盘指令偶尔变，与每周期发送全部状态相比的帧数*/
+static void TestBandwidth(void)
+{
+  memset(&local, 0, sizeof(local));
+  memset(&remote, 0, sizeof(remote));
+  BoardLinkTx tx(local_fields, 40);
+  BoardLinkRx rx(remote_fields);
+  int frames = 0;
+  const int messages = 1000;
+  for (int i = 0; i < messages; i++) {
+    local.gimbal_yaw = 0.01f * i;
+    if (i % 50 == 0)
+      local.chassis_vx = 0.1f * i;
+    if (i % 200 == 0)
+      local.mode++;
+    tx.update();
+    frames += Transfer(tx, rx);
+    CHECK(Same());
+  }
+  int naive = messages * ((BoardLink_MsgSize(local_fields, 6) - 1 + 7) / 8);   // 全部字段直接塞进8字节帧
+  printf("BoardLink: %d frames for %d messages, full state in 8-byte frames needs %d (%.0f%%)\n",
+         frames, messages, naive, 100.0 * frames / naive);
+  CHECK(frames * 2 < naive);
+}
+
+int main(void)
+{
+  TestSync();
+  TestLoss();
+  TestBusy();
+  TestCapacity();
+  TestBandwidth();
+  return CHECK_RESULT();
+}
@@ -0,0 +1,121 @@
+/*
+ * CAN接收时间戳的主机测试：16位硬件计数器回绕、最小相位收敛、与64位Clock配合时跨过CYCCNT回绕
+ * 帧模型：SOF时刻锁存硬件时间戳，帧长L位之后EOF，再经过lat个周期进入接收中断
+ * 换算结果应等于SOF时刻加上到目前为止最快一帧的(L*cpb + lat)，见CanStamp.hpp
+ */
+#include "CanStamp.hpp"
+#include "Clock.hpp"
+#include "Dwt.hpp"
+#include "Check.hpp"
+
+uint32_t dwt_stub_cycles;
+
+static const uint32_t kCyclesPerBit = 168;    // 与HW_can.cpp相同：168MHz，1Mbps
+static const uint64_t kPhase = 12345;         // CAN计数器为0时的CPU时间，不是整位数
+static const uint64_t kWrap = static_cast<uint64_t>(kCyclesPerBit) << 16;
+
+struct CanFrameGen {
+  uint32_t seed;
+  uint32_t next(uint32_t lo, uint32_t hi)
+  {
+    seed = seed * 1664525u + 1013904223u;
+    return lo + (seed >> 8) % (hi - lo + 1);
+  }
+};
+
+/*sof为SOF时刻，与计数器对齐到整位，硬件时间戳就是精确值*/
+static uint16_t HwStamp(uint64_t sof)
+{
+  return static_cast<uint16_t>((sof - kPhase) / kCyclesPerBit);
+}
+
+/*前面的帧慢，之后出现的最快一帧把相位拉到最终值，此后每帧的换算结果不变*/
+static void TestConvergence(void)
+{
+  CanRxStamper stamper(kCyclesPerBit);
+  CanFrameGen gen = {1};
+  uint64_t best = ~0ull;
+  uint32_t errors = 0;
+  for (uint32_t k = 0; k < 2000; k++) {
+    uint64_t sof = kPhase + (1000ull + k * 1000ull) * kCyclesPerBit;   // 每1ms一帧
+    uint32_t bits = gen.next(60, 130);
+    uint32_t lat = gen.next(20, 400);
+    if (k == 700) {   // 最短的帧恰好以最小延迟进入中断
+      bits = 47;
+      lat = 12;
+    }
+    uint64_t delay = static_cast<uint64_t>(bits) * kCyclesPerBit + lat;
+    if (delay < best)
+      best = delay;
+    uint64_t stamp = stamper.stamp(sof + delay, HwStamp(sof));
+    if (stamp != sof + best || stamper.latency() != delay - best)
+      errors++;
+  }
+  CHECK(errors == 0);
+  CHECK(best == 47ull * kCyclesPerBit + 12);
+}
+
+/*16位计数器约65.5ms回绕一次：密集的帧连续跨过回绕点，总线静默很多个回绕周期后相位仍然正确*/
+static void TestCounterWrap(void)
+{
+  CanRxStamper stamper(kCyclesPerBit);
+  const uint64_t delay = 47ull * kCyclesPerBit + 12;
+  uint32_t errors = 0;
+  uint64_t sof = kPhase + 0xFFF0ull * kCyclesPerBit;   // 第一帧就在回绕点之前
+  for (uint32_t k = 0; k < 4000; k++) {
+    if (stamper.stamp(sof + delay, HwStamp(sof)) != sof + delay)
+      errors++;
+    sof += 37ull * kCyclesPerBit;
+  }
+  CHECK(errors == 0);
+
+  sof += 153 * kWrap + 12345ull * kCyclesPerBit;   // 约10s静默
+  CHECK(stamper.stamp(sof + delay, HwStamp(sof)) == sof + delay);
+  sof += 500ull * kCyclesPerBit;
+  CHECK(stamper.stamp(sof + delay + 300, HwStamp(sof)) == sof + delay);
+  CHECK(stamper.latency() == 300);
+}
+
+/*HW_can中的用法：中断入口读32位CYCCNT，Clock_Extend扩展到64位再换算，运行中CYCCNT回绕两次*/
+static void TestClockExtend(void)
+{
+  const uint32_t kTick = 168000;            // TIM6每1ms调用一次Clock_Tick
+  const uint32_t kStart = 0xFFFFFFFFu - 5 * kTick;
+  dwt_stub_cycles = kStart;
+  Clock_Init(168000000);
+  CanRxStamper stamper(kCyclesPerBit);
+  CanFrameGen gen = {9};
+
+  const uint64_t min_delay = 47ull * kCyclesPerBit + 12;
+  uint64_t now = 0;   // 真实的64位时间，Clock_Init时为0
+  uint32_t extend_errors = 0;
+  uint32_t stamp_errors = 0;
+  for (uint32_t k = 0; k < 60000; k++) {
+    now += kTick;
+    dwt_stub_cycles = kStart + static_cast<uint32_t>(now);
+    Clock_Tick();
+
+    // 这1ms内到达一帧，SOF对齐到计数器的整位
+    uint64_t sof = kPhase + ((now - kPhase) / kCyclesPerBit + gen.next(1, 800)) * kCyclesPerBit;
+    uint64_t delay = k == 0 ? min_delay : min_delay + gen.next(0, 20000);
+    uint64_t isr = sof + delay;
+    uint32_t isr_cycles = kStart + static_cast<uint32_t>(isr);
+    dwt_stub_cycles = isr_cycles;
+    uint64_t extended = Clock_Extend(isr_cycles);
+    if (extended != isr)
+      extend_errors++;
+    if (stamper.stamp(extended, HwStamp(sof)) != sof + min_delay)
+      stamp_errors++;
+  }
+  CHECK(now > 2 * (1ull << 32));
+  CHECK(extend_errors == 0);
+  CHECK(stamp_errors == 0);
+}
+
+int main(void)
+{
+  TestConvergence();
+  TestCounterWrap();
+  TestClockExtend();
+  return CHECK_RESULT();
+}
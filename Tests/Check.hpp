@@ -0,0 +1,21 @@
+#ifndef _CHECK_H_
+#define _CHECK_H_
+
+#include <stdio.h>
+
+/*
+ * 主机测试用的最小断言：失败时打印位置并计数，不中断测试，main最后返回CHECK_RESULT()
+ */
+static int check_failures = 0;
+
+#define CHECK(cond)                                                        \
+  do {                                                                     \
+    if (!(cond)) {                                                         \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);      \
+      check_failures++;                                                    \
+    }                                                                      \
+  } while (0)
+
+#define CHECK_RESULT() (check_failures == 0 ? 0 : 1)
+
+#endif
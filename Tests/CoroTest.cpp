@@ -0,0 +1,159 @@
+/*
+ * 协程运行时的主机测试：等待条件满足才恢复、tick回绕时的延时、帧池用完时的处理、CAN帧队列
+ */
+#include "Coro.hpp"
+#include "Check.hpp"
+
+static CoFlag flag;
+static CoCanQueue queue;
+static int steps;
+static uint32_t resumed_at;
+static CoCanFrame received;
+
+static CoTask DelayTask(uint32_t ticks, uint32_t *now)
+{
+  co_await CoDelay(ticks);
+  resumed_at = *now;
+  steps++;
+}
+
+static CoTask FlagTask(void)
+{
+  uint32_t bits = co_await flag.wait(0x6);
+  steps = static_cast<int>(bits);
+}
+
+static CoTask QueueTask(void)
+{
+  received = co_await queue.receive();
+  steps++;
+}
+
+/*一直等待不结束的协程，用来占满帧池*/
+static CoTask IdleTask(void)
+{
+  co_await flag.wait(0x80000000u);
+}
+
+/*协程帧超过kCoroFrameSize*/
+static CoTask HugeTask(void)
+{
+  volatile uint8_t buffer[kCoroFrameSize];
+  buffer[0] = 1;
+  co_await CoDelay(1);
+  buffer[1] = buffer[0];
+}
+
+/*运行到所有协程结束，最多rounds次*/
+static void Drain(uint32_t now, int rounds = 4)
+{
+  for (int i = 0; i < rounds && Coro_Count() > 0; i++)
+    Coro_Run(now);
+}
+
+static void TestDelay(void)
+{
+  uint32_t now = 100;
+  steps = 0;
+  CHECK(Coro_Spawn(DelayTask(5, &now)));
+  Coro_Run(now);            // 运行到co_await，唤醒时刻为105
+  for (now = 101; now < 105; now++)
+    Coro_Run(now);
+  CHECK(steps == 0);
+  Coro_Run(now);
+  CHECK(steps == 1 && resumed_at == 105);
+  CHECK(Coro_Count() == 0);
+}
+
+/*唤醒时刻跨过2^32时按有符号差比较，不会立即唤醒也不会永远不唤醒*/
+static void TestDelayWrap(void)
+{
+  uint32_t now = 0xFFFFFFF0u;
+  steps = 0;
+  CHECK(Coro_Spawn(DelayTask(0x20, &now)));
+  Coro_Run(now);
+  for (now = 0xFFFFFFF1u; now != 0x10; now++)
+    Coro_Run(now);
+  CHECK(steps == 0);
+  Coro_Run(now);
+  CHECK(steps == 1 && resumed_at == 0x10);
+  CHECK(Coro_Count() == 0);
+}
+
+static void TestFlag(void)
+{
+  steps = -1;
+  CHECK(Coro_Spawn(FlagTask()));
+  Coro_Run(0);
+  flag.set(0x1);            // 不在等待的掩码中
+  Coro_Run(1);
+  CHECK(steps == -1);
+  flag.set(0x4);
+  Coro_Run(2);
+  CHECK(steps == 0x4);      // 只返回并清除掩码中的位
+  CHECK(flag.test(0x1) && !flag.test(0x4));
+  flag.take(0xFFFFFFFFu);
+  CHECK(Coro_Count() == 0);
+}
+
+static void TestQueue(void)
+{
+  steps = 0;
+  CHECK(Coro_Spawn(QueueTask()));
+  Coro_Run(0);
+  Coro_Run(1);
+  CHECK(steps == 0);
+  uint8_t data[8] = {2, 0x34};
+  CHECK(queue.push(0x330, data, 2));
+  Coro_Run(2);
+  CHECK(steps == 1 && received.id == 0x330 && received.len == 2 && received.data[0] == 2);
+  CHECK(queue.empty());
+
+  // 环形队列留一个空位区分满和空，满时丢弃新帧
+  for (uint8_t i = 0; i < kCoroCanQueueLen - 1; i++)
+    CHECK(queue.push(i, data, 8));
+  CHECK(!queue.push(99, data, 8));
+  CHECK(queue.dropped() == 1);
+  CoCanFrame frame;
+  for (uint8_t i = 0; i < kCoroCanQueueLen - 1; i++)
+    CHECK(queue.pop(&frame) && frame.id == i);
+  CHECK(!queue.pop(&frame));
+}
+
+/*帧池用完或帧太大时operator new返回空，协程函数返回无效的CoTask，Coro_Spawn失败；帧在协程结束后回收*/
+static void TestPoolExhaustion(void)
+{
+  CoTask huge = HugeTask();
+  CHECK(!huge.valid());
+  CHECK(!Coro_Spawn(HugeTask()));
+
+  for (uint8_t i = 0; i < kCoroMaxTasks; i++)
+    CHECK(Coro_Spawn(IdleTask()));
+  CHECK(Coro_Count() == kCoroMaxTasks);
+  CoTask extra = IdleTask();
+  CHECK(!extra.valid());
+  CHECK(!Coro_Spawn(IdleTask()));
+
+  Coro_Run(0);
+  flag.set(0x80000000u);
+  Coro_Run(1);              // 第一个协程取走标志后结束，其它协程继续等待
+  CHECK(Coro_Count() == kCoroMaxTasks - 1);
+  CHECK(Coro_Spawn(IdleTask()));   // 回收的帧可以再用
+
+  for (uint8_t i = 0; i < kCoroMaxTasks; i++) {
+    flag.set(0x80000000u);
+    Coro_Run(2 + i);
+  }
+  Drain(100);
+  CHECK(Coro_Count() == 0);
+}
+
+int main(void)
+{
+  TestDelay();
+  TestDelayWrap();
+  TestFlag();
+  TestQueue();
+  TestPoolExhaustion();
+  return CHECK_RESULT();
+}
@@ -0,0 +1,114 @@
+/*
+ * 模糊PID的主机测试：语言值不泄漏到全局，第一拍不产生虚假的误差变化率，
+ * 查找表在网格点上与手算的推理结果相同，闭环中增益按规则的方向调整
+ */
+#include "FuzzyPid.hpp"
+#include "MotorModel.hpp"
+#include "Check.hpp"
+
+#include <math.h>
+
+/*包含FuzzyRules.hpp后全局仍然可以使用这些短名字*/
+static const int NB = 1, ZO = 2, PB = 3;
+
+/*第一拍的ec按0处理：与误差保持不变两拍后的调整量相同*/
+static void TestFirstSample(void)
+{
+  PidParams params = {1.0f, 0.5f, 0.01f, 100.0f, 1000.0f};
+  FuzzyPidConfig config = {50.0f, 500.0f, 0.5f, 0.2f, 0.005f};
+  Pid first_pid(params);
+  FuzzyPid first(first_pid, config);
+  first.pidCalc(30.0f, 0, 0.001f);
+
+  Pid steady_pid(params);
+  FuzzyPid steady(steady_pid, config);
+  steady.pidCalc(30.0f, 0, 0.001f);
+  steady.pidCalc(30.0f, 0, 0.001f);
+
+  CHECK(first.dkp() == steady.dkp());
+  CHECK(first.dki() == steady.dki());
+  CHECK(first.dkd() == steady.dkd());
+  CHECK(first.dkp() > 0 && first.dkp() < 1.0f);
+}
+
+/*
+ * 归一化系数取1、T取1，先给e-ec再给e，第二拍的(e, ec)就正好落在网格点上
+ * 手算：隶属度在距离0、0.5、1处为1、2/3、1/3，结果 = Σw*规则/Σw/3
+ */
+static void Surface(float e, float ec, float *dkp, float *dki, float *dkd)
+{
+  PidParams params = {1.0f, 1.0f, 1.0f, 100.0f, 1000.0f};
+  FuzzyPidConfig config = {3.0f, 3.0f, 1.0f, 1.0f, 1.0f};
+  Pid pid(params);
+  FuzzyPid fuzzy(pid, config);
+  fuzzy.pidCalc(e - ec, 0, 1.0f);
+  fuzzy.pidCalc(e, 0, 1.0f);
+  *dkp = fuzzy.dkp();
+  *dki = fuzzy.dki();
+  *dkd = fuzzy.dkd();
+}
+
+static void TestSurfacePoints(void)
+{
+  float dkp, dki, dkd;
+  // (ZO, ZO)：行NS/ZO/PS、列NS/ZO/PS参与，权重1/3、1、1/3
+  //   kp：(1/3*(1/3+1) + 1/3*(1+1/3)) / (25/9) / 3 = 8/75
+  //   ki：(1/3*2 + 5 + 1/3*2) / (25/9) / 3 = 19/25
+  Surface(0, 0, &dkp, &dki, &dkd);
+  CHECK(fabsf(dkp - 8.0f / 75) < 1e-6f);
+  CHECK(fabsf(dki - 19.0f / 25) < 1e-6f);
+
+  // (PB, PB)：参与的四条kp规则都是PB
+  Surface(3.0f, 3.0f, &dkp, &dki, &dkd);
+  CHECK(fabsf(dkp - 1.0f) < 1e-6f);
+
+  // (ZO, 0.5)：列ZO、PS的权重都是2/3；kd规则只有(NS,ZO)、(PS,ZO)为NS
+  //   kd：(-2/9 - 2/9) / (5/3*4/3) / 3 = -1/15
+  Surface(0, 0.5f, &dkp, &dki, &dkd);
+  CHECK(fabsf(dkd - (-1.0f / 15)) < 1e-6f);
+
+  // (NB, ZO)：kp行NB/NM与列NS/ZO/PS，(1*(3/3+2+2/3) + 1/3*(2/3+2+1/3)) / (4/3*5/3) / 3 = 7/10
+  Surface(-3.0f, 0, &dkp, &dki, &dkd);
+  CHECK(fabsf(dkp - 0.7f) < 1e-6f);
+}
+
+/*
+ * 电机模型上的阶跃：误差大、还没开始减小时kp加大、ki和kd减小；
+ * 接近稳态时ki加大消除静差，与规则库的方向一致，且最终收敛
+ */
+static void TestClosedLoopDirection(void)
+{
+  const float T = 0.001f;
+  const float ref = 300.0f;
+  PidParams params = {0.006f, 0.1f, 0.00005f, 100.0f, 3.0f};
+  params.separation = 0;
+  FuzzyPidConfig config = {300.0f, 6000.0f, 0.004f, 0.05f, 0.00003f};
+  Pid pid(params);
+  FuzzyPid fuzzy(pid, config);
+  MotorModel motor(200.0f, 0.05f, 10);
+  float fdb = 0;
+  bool early_ok = true;
+  for (int i = 0; i < 3000; i++) {
+    fdb = motor.step(fuzzy.pidCalc(ref, fdb, T), T);
+    if (i < 10) {   // 滞后之内反馈还没动，e为PB、ec为ZO
+      PidParams now = pid.getParams();
+      early_ok = early_ok && fuzzy.dkp() > 0 && fuzzy.dki() < 0 && fuzzy.dkd() < 0 &&
+                 now.kp > params.kp && now.ki < params.ki && now.kd < params.kd;
+    }
+  }
+  CHECK(early_ok);
+  CHECK(fabsf(fdb - ref) < 0.01f * ref);
+  CHECK(fuzzy.dki() > 0 && pid.getParams().ki > params.ki);
+  printf("FuzzyPid: 300rpm step, final %.2f, gains at steady state kp %.4f ki %.4f kd %.6f\n",
+         fdb, pid.getParams().kp, pid.getParams().ki, pid.getParams().kd);
+}
+
+int main(void)
+{
+  CHECK(NB + ZO + PB == 6);
+  CHECK(static_cast<int8_t>(FuzzyRules::kKp[0][0]) == static_cast<int8_t>(FuzzyTerm::PB));
+  TestFirstSample();
+  TestSurfacePoints();
+  TestClosedLoopDirection();
+  return CHECK_RESULT();
+}
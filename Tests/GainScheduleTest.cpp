@@ -0,0 +1,142 @@
+/*
+ * 增益调度的主机测试：setGains换增益时输出连续(包括ki经过0)、积分限幅，
+ * 调度变量扫过断点时输出连续，以及与直接pidCalc相比的耗时
+ */
+#include "GainSchedule.hpp"
+#include "Bench.hpp"
+#include "Check.hpp"
+
+#include <math.h>
+
+static const float T = 0.001f;
+
+/*先积分一段时间，再只换ki：同一个误差下换增益前后输出相同*/
+static void TestSetGainsContinuity(void)
+{
+  PidParams params = {2.0f, 5.0f, 0, 100.0f, 1000.0f};
+  params.separation = 0;
+  Pid pid(params);
+  for (int i = 0; i < 500; i++)
+    pid.pidCalc(10.0f, 0, T);
+  float before = pid.pidCalc(10.0f, 0, T);
+
+  // ki减半：积分加倍，积分项不变；下一拍与不换增益时只差新积分的一步
+  pid.setGains(2.0f, 2.5f, 0);
+  float after = pid.pidCalc(10.0f, 0, T);
+  CHECK(fabsf(after - (before + 2.5f * 10.0f * T)) < 1e-3f);
+
+  // ki变为0：积分项转入bias，输出不跳变
+  pid.setGains(2.0f, 0, 0);
+  float zero_ki = pid.pidCalc(10.0f, 0, T);
+  CHECK(fabsf(zero_ki - after) < 1e-3f);
+
+  // ki再变为非0：bias转回积分
+  pid.setGains(2.0f, 4.0f, 0);
+  float back = pid.pidCalc(10.0f, 0, T);
+  CHECK(fabsf(back - (zero_ki + 4.0f * 10.0f * T)) < 1e-3f);
+}
+
+/*ki变小使换算后的积分超出限幅时，积分被限幅，而不是越过integral_limit*/
+static void TestSetGainsClamp(void)
+{
+  PidParams params = {0, 10.0f, 0, 5.0f, 1000.0f};
+  params.separation = 0;
+  Pid pid(params);
+  for (int i = 0; i < 10000; i++)
+    pid.pidCalc(10.0f, 0, T);
+  pid.pidCalc(0, 0, T);
+  CHECK(pid.pidCalc(0, 0, T) == 50.0f);   // 积分停在限幅5
+  pid.setGains(0, 1.0f, 0);                // 需要积分50，限幅到5
+  CHECK(pid.pidCalc(0, 0, T) == 5.0f);
+}
+
+/*只换kd时沿用缓存的1/T，结果与一开始就用这个kd的控制器相同(只差乘倒数与除法的舍入)*/
+static void TestSetGainsKd(void)
+{
+  PidParams params = {2.0f, 5.0f, 0, 100.0f, 1000.0f};
+  params.separation = 0;
+  Pid pid(params);
+  PidParams with_d = params;
+  with_d.kd = 0.01f;
+  Pid expect(with_d);
+  for (int i = 0; i < 100; i++) {
+    pid.pidCalc(10.0f, sinf(i * 0.1f), T);
+    expect.pidCalc(10.0f, sinf(i * 0.1f), T);
+  }
+  pid.setGains(2.0f, 5.0f, 0.01f);
+  for (int i = 100; i < 200; i++) {
+    float out = pid.pidCalc(10.0f, sinf(i * 0.1f), T);
+    CHECK(fabsf(out - expect.pidCalc(10.0f, sinf(i * 0.1f), T)) < 1e-4f);
+  }
+}
+
+/*setGains在ki为0时把积分项放进bias；setParams换成新参数后不再带着旧的bias*/
+static void TestSetParamsClearsBias(void)
+{
+  PidParams params = {2.0f, 5.0f, 0, 100.0f, 1000.0f};
+  params.separation = 0;
+  Pid pid(params);
+  for (int i = 0; i < 500; i++)
+    pid.pidCalc(10.0f, 0, T);
+  pid.setGains(2.0f, 0, 0);
+  CHECK(pid.pidCalc(0, 0, T) > 20.0f);     // 积分项约25，还在bias中
+  pid.setParams(params);
+  CHECK(fabsf(pid.pidCalc(0, 0, T)) < 0.1f);   // 只剩ki为0期间积下的一步
+}
+
+static const GainPoint points[] = {
+    {0, 4.0f, 2.0f, 0.01f},
+    {10.0f, 2.0f, 1.0f, 0.005f},
+    {50.0f, 1.0f, 0, 0},
+    {200.0f, 0.5f, 0.5f, 0},
+};
+
+/*调度变量连续扫过所有断点，包括ki为0的点，相邻两拍的输出变化有界*/
+static void TestScheduleContinuity(void)
+{
+  PidParams params = {1.0f, 1.0f, 0, 100.0f, 1000.0f};
+  params.separation = 0;
+  Pid pid(params);
+  GainSchedule schedule(pid);
+  CHECK(schedule.load(points, 4));
+  CHECK(!schedule.load(points, 0));
+
+  float last = schedule.pidCalc(20.0f, 0, T, 0);
+  CHECK(schedule.count() == 4);
+  float worst = 0;
+  for (int i = 1; i <= 25000; i++) {
+    float x = i * 0.01f;
+    float out = schedule.pidCalc(20.0f, 0, T, x);
+    if (fabsf(out - last) > worst)
+      worst = fabsf(out - last);
+    last = out;
+  }
+  printf("GainSchedule: largest output step while sweeping x 0..250: %.4f\n", worst);
+  CHECK(worst < 0.05f);
+}
+
+static void BenchSchedule(void)
+{
+  PidParams params = {1.0f, 1.0f, 0.001f, 100.0f, 1000.0f};
+  Pid plain(params);
+  Pid scheduled(params);
+  GainSchedule schedule(scheduled);
+  schedule.load(points, 4);
+  float xs[256];
+  for (int i = 0; i < 256; i++)
+    xs[i] = i * 0.9f;
+  double plain_ns = BenchNs([&](uint32_t i) { BenchKeep(plain.pidCalc(20.0f, xs[i & 255] * 0.1f, T)); }, 1000000);
+  double sched_ns = BenchNs([&](uint32_t i) { BenchKeep(schedule.pidCalc(20.0f, xs[i & 255] * 0.1f, T, xs[i & 255])); }, 1000000);
+  printf("GainSchedule: %.2f ns/call, plain pidCalc %.2f ns/call (4 breakpoints)\n", sched_ns, plain_ns);
+}
+
+int main(void)
+{
+  TestSetGainsContinuity();
+  TestSetGainsClamp();
+  TestSetGainsKd();
+  TestSetParamsClearsBias();
+  TestScheduleContinuity();
+  BenchSchedule();
+  return CHECK_RESULT();
+}
@@ -0,0 +1,43 @@
+#ifndef _MOTOR_MODEL_H_
+#define _MOTOR_MODEL_H_
+
+#include <math.h>
+
+/*
+ * 主机仿真用的电机速度模型：K/(tau*s+1)*e^(-L*s)，输入为电流(A)，输出为转速(rpm)
+ * 滞后来自电流环和CAN往返，按采样周期离散，前向欧拉积分
+ */
+struct MotorModel {
+  float K;
+  float tau;
+  static const int kMaxDelay = 64;
+  float queue[kMaxDelay] = {};
+  int delay;
+  int head = 0;
+  float speed = 0;
+
+  MotorModel(float k, float t, int delay_steps) : K(k), tau(t), delay(delay_steps) {}
+
+  float step(const float input, const float T)
+  {
+    float delayed = queue[head];
+    queue[head] = input;
+    head = (head + 1) % delay;
+    speed += (K * delayed - speed) * (T / tau);
+    return speed;
+  }
+
+  /*相位穿越频率处的临界增益和周期：atan(w*tau) + w*L = pi，闭环中反馈还要晚一个采样周期*/
+  void critical(const float T, float *ku, float *tu) const
+  {
+    double L = (delay + 1) * T, lo = 0, hi = M_PI / L;
+    for (int i = 0; i < 100; i++) {
+      double w = 0.5 * (lo + hi);
+      if (atan(w * tau) + w * L < M_PI) lo = w; else hi = w;
+    }
+    *ku = static_cast<float>(sqrt(1 + lo * tau * lo * tau) / K);
+    *tu = static_cast<float>(2 * M_PI / lo);
+  }
+};
+
+#endif
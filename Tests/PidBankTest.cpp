@@ -0,0 +1,104 @@
+/*
+ * PidBank的主机测试：与N个独立的Pid逐位比较，检查不支持的参数被拒绝，比较两者的耗时
+ */
+#include "PidBank.hpp"
+#include "Bench.hpp"
+#include "Check.hpp"
+
+#include <math.h>
+#include <new>
+
+static const int kSteps = 1024;
+static float refs[kSteps][32];
+static float fdbs[kSteps][32];
+
+static void MakeSignals(void)
+{
+  uint32_t seed = 7;
+  for (int k = 0; k < kSteps; k++) {
+    for (int i = 0; i < 32; i++) {
+      seed = seed * 1664525u + 1013904223u;
+      refs[k][i] = (k / 128 % 2) ? 50.0f + i : -20.0f;
+      fdbs[k][i] = 40.0f * sinf(k * 0.02f + i) + ((seed >> 8) * (1.0f / 16777216.0f) - 0.5f);
+    }
+  }
+}
+
+static PidParams AxisParams(size_t i)
+{
+  PidParams params;
+  params.kp = 2.0f + i;
+  params.ki = 0.5f + 0.1f * i;
+  params.kd = 0.01f * i;
+  params.integral_limit = 100.0f;
+  params.output_limit = 300.0f;
+  return params;
+}
+
+template <size_t N>
+static void TestAndBench(void)
+{
+  const float T = 0.001f;
+  PidBank<N> bank(T);
+  PidParams params[N];
+  Pid *pids[N];
+  static unsigned char storage[N][sizeof(Pid)];
+  for (size_t i = 0; i < N; i++) {
+    params[i] = AxisParams(i);
+    CHECK(bank.setParams(i, params[i]));
+    pids[i] = new (storage[i]) Pid(params[i]);
+  }
+
+  // 只用积分限幅时与Pid逐位相同
+  float out[N];
+  for (int k = 0; k < kSteps; k++) {
+    bank.calc(refs[k], fdbs[k], out, 0xFFFFFFFFu);
+    for (size_t i = 0; i < N; i++)
+      CHECK(out[i] == pids[i]->pidCalc(refs[k][i], fdbs[k][i], T));
+  }
+
+  double bank_ns = BenchNs([&](uint32_t k) { bank.calc(refs[k % kSteps], fdbs[k % kSteps], out, 0xFFFFFFFFu); BenchKeep(out); }, 200000);
+  double pid_ns = BenchNs([&](uint32_t k) {
+    for (size_t i = 0; i < N; i++)
+      out[i] = pids[i]->pidCalc(refs[k % kSteps][i], fdbs[k % kSteps][i], T);
+    BenchKeep(out);
+  }, 200000);
+  printf("PidBank<%2zu>: %6.2f ns/step, %2zu x Pid %6.2f ns/step (%.2fx)\n", N, bank_ns, N, pid_ns, pid_ns / bank_ns);
+}
+
+/*PidBank不实现的功能：参数被拒绝，该轴保持原来的参数*/
+static void TestRejects(void)
+{
+  PidBank<2> bank(0.001f);
+  PidParams params = AxisParams(1);
+  CHECK(bank.setParams(0, params));
+  CHECK(!bank.setParams(2, params));
+
+  PidParams bad = params;
+  bad.anti_windup = kPidWindupBackCalc;
+  CHECK(!bank.setParams(0, bad));
+  bad = params;
+  bad.b = 0.5f;
+  CHECK(!bank.setParams(0, bad));
+  bad = params;
+  bad.c = 1.0f;
+  CHECK(!bank.setParams(0, bad));
+  bad = params;
+  bad.Tf = 0.002f;
+  CHECK(!bank.setParams(0, bad));
+
+  float ref[2] = {10.0f, 0}, fdb[2] = {0, 0}, out[2];
+  bank.calc(ref, fdb, out, 1);
+  CHECK(out[0] == params.kp * 10.0f + params.ki * 10.0f * 0.0005f);
+}
+
+int main(void)
+{
+  MakeSignals();
+  TestRejects();
+  TestAndBench<1>();
+  TestAndBench<4>();
+  TestAndBench<7>();
+  TestAndBench<14>();
+  return CHECK_RESULT();
+}
@@ -0,0 +1,89 @@
+/*
+ * PidQ31的主机测试：与浮点Pid换算成int16指令后的结果比较，比较两者的耗时
+ * 主机上没有DSP指令，饱和加法和饱和移位用C++实现
+ */
+#include "PidQ31.hpp"
+#include "Bench.hpp"
+#include "Check.hpp"
+
+#include <math.h>
+#include <stdlib.h>
+
+static const float kCmdPerAmp = 16384.0f / 3.0f;   // GM6020电流指令
+static const int kSamples = 4096;
+static int16_t refs[kSamples];
+static int16_t fdbs[kSamples];
+
+/*速度参考为几段阶跃，反馈为正弦加整数噪声，单位rpm*/
+static void MakeSignals(void)
+{
+  uint32_t seed = 11;
+  for (int i = 0; i < kSamples; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    refs[i] = (i / 512 % 2) ? 200 : -120;
+    fdbs[i] = static_cast<int16_t>(lrintf(150.0f * sinf(i * 0.005f))) + static_cast<int16_t>((seed >> 28) - 8);
+  }
+}
+
+static PidParams SpeedParams(void)
+{
+  PidParams params = {0.003f, 0.1f, 0.00001f, 10.0f, 2.0f};
+  return params;
+}
+
+/*与浮点结果的差别来自系数量化和取整方式(右移向下取整，浮点转换向零取整)，不超过2个指令单位*/
+static void TestMatchesFloat(void)
+{
+  const float T = 0.001f;
+  PidParams params = SpeedParams();
+  Pid pid(params);
+  PidQ31 q31(params, T, kCmdPerAmp);
+  int worst = 0;
+  for (int k = 0; k < 100000; k++) {
+    int i = k % kSamples;
+    int16_t expect = static_cast<int16_t>(pid.pidCalc(refs[i], fdbs[i], T) * kCmdPerAmp);
+    int diff = abs(q31.pidCalc(refs[i], fdbs[i]) - expect);
+    if (diff > worst)
+      worst = diff;
+  }
+  printf("PidQ31: worst difference from float Pid %d counts of %d\n", worst, static_cast<int>(2.0f * kCmdPerAmp));
+  CHECK(worst <= 2);
+}
+
+/*输出限幅和积分限幅：误差长时间同向时停在限幅值，不回绕*/
+static void TestLimits(void)
+{
+  const float T = 0.001f;
+  PidParams params = SpeedParams();
+  params.separation = 0;
+  PidQ31 q31(params, T, kCmdPerAmp);
+  int16_t cmd = 0;
+  for (int i = 0; i < 50000; i++)
+    cmd = q31.pidCalc(30000, -30000);
+  CHECK(cmd == static_cast<int16_t>(2.0f * kCmdPerAmp));
+  for (int i = 0; i < 50000; i++)
+    cmd = q31.pidCalc(-30000, 30000);
+  CHECK(cmd == -static_cast<int16_t>(2.0f * kCmdPerAmp));
+}
+
+static void BenchQ31(void)
+{
+  const float T = 0.001f;
+  PidParams params = SpeedParams();
+  Pid pid(params);
+  PidQ31 q31(params, T, kCmdPerAmp);
+  double q31_ns = BenchNs([&](uint32_t i) { BenchKeep(q31.pidCalc(refs[i % kSamples], fdbs[i % kSamples])); }, 1000000);
+  double float_ns = BenchNs([&](uint32_t i) {
+    BenchKeep(static_cast<int16_t>(pid.pidCalc(refs[i % kSamples], fdbs[i % kSamples], T) * kCmdPerAmp));
+  }, 1000000);
+  printf("PidQ31: %.2f ns/call, float Pid with int16 conversion %.2f ns/call\n", q31_ns, float_ns);
+}
+
+int main(void)
+{
+  MakeSignals();
+  TestMatchesFloat();
+  TestLimits();
+  BenchQ31();
+  return CHECK_RESULT();
+}
@@ -0,0 +1,102 @@
+/*
+ * PidStore和增益记录的主机测试：记录的打包、校验，以及带增益记录的板间状态能否同步
+ */
+#include "PidStore.hpp"
+#include "BoardLink.hpp"
+#include "Check.hpp"
+
+#include <math.h>
+
+/*与main.cpp中的BoardLinkState布局相同*/
+struct LinkState {
+  float gimbal_yaw;
+  float gimbal_pitch;
+  float chassis_vx;
+  float chassis_vy;
+  float chassis_wz;
+  uint8_t mode;
+  PidGainsRecord speed_gains;
+  uint8_t speed_params_seq;
+};
+
+static LinkState local;
+static LinkState remote;
+static constexpr BoardLinkField local_fields[] = {
+    BOARD_LINK_FIELD(local.gimbal_yaw), BOARD_LINK_FIELD(local.gimbal_pitch),
+    BOARD_LINK_FIELD(local.chassis_vx), BOARD_LINK_FIELD(local.chassis_vy),
+    BOARD_LINK_FIELD(local.chassis_wz), BOARD_LINK_FIELD(local.mode),
+    BOARD_LINK_FIELD(local.speed_gains), BOARD_LINK_FIELD(local.speed_params_seq)};
+static constexpr BoardLinkField remote_fields[] = {
+    BOARD_LINK_FIELD(remote.gimbal_yaw), BOARD_LINK_FIELD(remote.gimbal_pitch),
+    BOARD_LINK_FIELD(remote.chassis_vx), BOARD_LINK_FIELD(remote.chassis_vy),
+    BOARD_LINK_FIELD(remote.chassis_wz), BOARD_LINK_FIELD(remote.mode),
+    BOARD_LINK_FIELD(remote.speed_gains), BOARD_LINK_FIELD(remote.speed_params_seq)};
+static_assert(BoardLink_MsgSize(local_fields, 8) == 44);
+static_assert(BoardLink_Fits(local_fields, 8));
+
+static void TestRecord(void)
+{
+  PidParams sent = {0.004f, 0.2f, 0.00002f, 8.0f, 1.5f};
+  PidGainsRecord record;
+  PidGains_Pack(sent, &record);
+  CHECK(record.version == kPidGainsVersion);
+
+  // 只覆盖增益和限幅，其它参数保持接收方的值
+  PidParams params = {0.003f, 0.1f, 0.00001f, 10.0f, 2.0f};
+  params.separation = 50.0f;
+  params.anti_windup = kPidWindupBackCalc;
+  CHECK(PidGains_Unpack(record, &params));
+  CHECK(params.kp == sent.kp && params.ki == sent.ki && params.kd == sent.kd);
+  CHECK(params.integral_limit == sent.integral_limit && params.output_limit == sent.output_limit);
+  CHECK(params.separation == 50.0f && params.anti_windup == kPidWindupBackCalc);
+
+  PidParams before = params;
+  PidGainsRecord bad = record;
+  bad.version = kPidGainsVersion + 1;
+  CHECK(!PidGains_Unpack(bad, &params));
+  bad = record;
+  bad.ki = NAN;
+  CHECK(!PidGains_Unpack(bad, &params));
+  bad = record;
+  bad.output_limit = -1.0f;
+  CHECK(!PidGains_Unpack(bad, &params));
+  CHECK(params.kp == before.kp && params.output_limit == before.output_limit);
+}
+
+/*带增益记录的完整状态在一条消息内同步到对端，对端换入参数*/
+static void TestLinkSync(void)
+{
+  BoardLinkTx tx(local_fields, 40);
+  BoardLinkRx rx(remote_fields);
+  CHECK(tx.ok() && rx.ok());
+
+  PidParams sent = {0.004f, 0.2f, 0.00002f, 8.0f, 1.5f};
+  PidGains_Pack(sent, &local.speed_gains);
+  local.speed_params_seq = 1;
+  CHECK(tx.update());
+  uint8_t data[8];
+  uint8_t len;
+  while (tx.peekFrame(data, &len)) {
+    tx.popFrame();
+    rx.onFrame(data, len);
+  }
+  CHECK(rx.synced());
+  CHECK(remote.speed_params_seq == 1);
+
+  PidParams params = {0.003f, 0.1f, 0.00001f, 10.0f, 2.0f};
+  Pid pid(params);
+  PidStore store(pid);
+  PidGainsRecord gains = remote.speed_gains;
+  PidParams next = store.active();
+  CHECK(PidGains_Unpack(gains, &next));
+  CHECK(store.stage(next));
+  CHECK(store.commit());
+  CHECK(pid.getParams().kp == sent.kp && pid.getParams().output_limit == sent.output_limit);
+}
+
+int main(void)
+{
+  TestRecord();
+  TestLinkSync();
+  return CHECK_RESULT();
+}
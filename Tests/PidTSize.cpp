@@ -0,0 +1,10 @@
+/*
+ * 代码大小统计：PidTTest中用到的常量增益变体在这里显式实例化pidCalc(它们没有setParams，不能实例化整个类)，
+ * 运行时增益的变体在PidT.cpp中；构建时用nm列出各变体pidCalc的字节数(主机指令集，只用于比较变体之间的相对大小)
+ */
+#include "PidT.hpp"
+
+template float PidT<kPidPID, kPidClampBoth, PidConstGains<50.0f, 12.0f, 0.02f, 400.0f, 16384.0f>>::pidCalc(
+    const float, const float, const float);
+template float PidT<kPidPI, kPidClampBoth, PidConstGains<50.0f, 12.0f, 0.0f, 400.0f, 16384.0f>>::pidCalc(
+    const float, const float, const float);
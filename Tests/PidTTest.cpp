@@ -0,0 +1,72 @@
+/*
+ * PidT的主机测试：与Pid逐位比较，比较对象大小(sizeof，不是代码大小)和耗时
+ * 各变体pidCalc的代码大小由构建时的PidTSizeReport目标打印，见CMakeLists.txt
+ */
+#include "PidT.hpp"
+#include "Bench.hpp"
+#include "Check.hpp"
+
+#include <math.h>
+
+static const int kSamples = 4096;
+static float refs[kSamples];
+static float fdbs[kSamples];
+
+static void MakeSignals(void)
+{
+  uint32_t seed = 3;
+  for (int i = 0; i < kSamples; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    refs[i] = (i / 512 % 2) ? 120.0f : -60.0f;
+    fdbs[i] = 100.0f * sinf(i * 0.01f) + ((seed >> 8) * (1.0f / 16777216.0f) - 0.5f) * 4.0f;
+  }
+}
+
+using RuntimePid = PidT<kPidPID, kPidClampBoth>;
+using ConstPid = PidT<kPidPID, kPidClampBoth, PidConstGains<50.0f, 12.0f, 0.02f, 400.0f, 16384.0f>>;
+using ConstPi = PidT<kPidPI, kPidClampBoth, PidConstGains<50.0f, 12.0f, 0.0f, 400.0f, 16384.0f>>;
+
+static PidParams params = {50.0f, 12.0f, 0.02f, 400.0f, 16384.0f};
+
+/*PidT<kPidPID, kPidClampBoth>与Pid的结果逐位相同，常量增益与运行时增益相同*/
+static void TestMatchesPid(void)
+{
+  const float T = 0.001f;
+  Pid pid(params);
+  RuntimePid runtime;
+  runtime.setParams(params);
+  ConstPid constant;
+  for (int k = 0; k < 100000; k++) {
+    int i = k % kSamples;
+    float out = pid.pidCalc(refs[i], fdbs[i], T);
+    CHECK(runtime.pidCalc(refs[i], fdbs[i], T) == out);
+    CHECK(constant.pidCalc(refs[i], fdbs[i], T) == out);
+  }
+  static_assert(RuntimePid::kRuntimeGains && !ConstPid::kRuntimeGains);
+}
+
+static void BenchPidT(void)
+{
+  const float T = 0.001f;
+  Pid pid(params);
+  RuntimePid runtime;
+  runtime.setParams(params);
+  ConstPid constant;
+  ConstPi pi;
+  double pid_ns = BenchNs([&](uint32_t i) { BenchKeep(pid.pidCalc(refs[i % kSamples], fdbs[i % kSamples], T)); }, 1000000);
+  double runtime_ns = BenchNs([&](uint32_t i) { BenchKeep(runtime.pidCalc(refs[i % kSamples], fdbs[i % kSamples], T)); }, 1000000);
+  double const_ns = BenchNs([&](uint32_t i) { BenchKeep(constant.pidCalc(refs[i % kSamples], fdbs[i % kSamples], T)); }, 1000000);
+  double pi_ns = BenchNs([&](uint32_t i) { BenchKeep(pi.pidCalc(refs[i % kSamples], fdbs[i % kSamples], T)); }, 1000000);
+  printf("Pid                 sizeof %3zu bytes %5.2f ns/call\n", sizeof(Pid), pid_ns);
+  printf("PidT runtime gains  sizeof %3zu bytes %5.2f ns/call\n", sizeof(RuntimePid), runtime_ns);
+  printf("PidT const gains    sizeof %3zu bytes %5.2f ns/call\n", sizeof(ConstPid), const_ns);
+  printf("PidT const PI       sizeof %3zu bytes %5.2f ns/call\n", sizeof(ConstPi), pi_ns);
+}
+
+int main(void)
+{
+  MakeSignals();
+  TestMatchesPid();
+  BenchPidT();
+  return CHECK_RESULT();
+}
@@ -0,0 +1,379 @@
+/*
+ * Pid的主机测试：预先计算系数的pidCalc与逐次除法的参照实现比较结果和耗时，
+ * 抗积分饱和策略在饱和的电机模型上的阶跃响应
+ * 参照实现具有相同的功能(积分分离、抗饱和、二自由度、bias、微分滤波)，只是每次调用都做除法，
+ * 耗时的差别只来自预先计算；主机上除法很便宜，数字只作记录，
+ * Cortex-M4上VDIV.F32为14个周期且不流水，片上耗时看main.cpp中的pid_calc_cycles
+ */
+#include "PID.hpp"
+#include "MotorModel.hpp"
+#include "Bench.hpp"
+#include "Check.hpp"
+
+#include <math.h>
+
+/*参照实现：与Pid功能相同，系数每次调用时由参数和T现算*/
+struct NaivePid {
+  PidParams params;
+  float integral = 0, last_error = 0, last_fdb = 0, last_ref = 0;
+  float derivative = 0;   /*滤波后的微分项，也用于确定允许的误差*/
+  float bias = 0;
+  int8_t saturated = 0;
+
+  __attribute__((noinline)) float calc(const float ref, const float fdb, const float T)
+  {
+    float error = ref - fdb;
+    float i = integral;
+    bool integrate = params.separation <= 0 || fabsf(error) < params.separation;
+    if (params.anti_windup == kPidWindupConditional && saturated * error > 0)
+      integrate = false;
+    if (integrate)
+      i += (error + last_error) / 2 * T;
+    integral = Clamp(i, params.integral_limit);
+    float delta = (last_fdb - fdb) + params.c * (ref - last_ref);
+    if (params.Tf > 0)
+      derivative = (params.Tf * derivative + params.kd * delta) / (params.Tf + T);
+    else
+      derivative = params.kd * (delta / T);
+    float output = params.kp * (params.b * ref - fdb) + params.ki * i + derivative + bias;
+    last_error = error;
+    last_fdb = fdb;
+    last_ref = ref;
+    float limited = Clamp(output, params.output_limit);
+    saturated = (limited < output) - (limited > output);
+    if (params.anti_windup == kPidWindupBackCalc && saturated != 0 && params.ki != 0)
+      integral = Clamp(integral + params.tracking_gain / params.ki * T * (limited - output), params.integral_limit);
+    return limited;
+  }
+
+  static float Clamp(const float x, const float limit)
+  {
+    return x > limit ? limit : (x < -limit ? -limit : x);
+  }
+};
+
+static const int kSamples = 4096;
+static float refs[kSamples];
+static float fdbs[kSamples];
+
+/*转速环量级的参考和带噪声的反馈，误差有时超过积分分离阈值*/
+static void MakeSignals(void)
+{
+  uint32_t seed = 1;
+  for (int i = 0; i < kSamples; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    float noise = ((seed >> 8) * (1.0f / 16777216.0f) - 0.5f) * 4.0f;
+    refs[i] = (i / 512 % 2) ? 120.0f : -60.0f;
+    fdbs[i] = 100.0f * sinf(i * 0.01f) + noise;
+  }
+}
+
+static PidParams SpeedParams(float kd)
+{
+  PidParams params;
+  params.kp = 50.0f;
+  params.ki = 12.0f;
+  params.kd = kd;
+  params.integral_limit = 400.0f;
+  params.output_limit = 16384.0f;
+  return params;
+}
+
+/*P、I项与原实现逐位相同；D项相对误差不超过2ulp，输出的差别只来自D项*/
+static void TestMatchesNaive(void)
+{
+  const float T = 0.001f;
+  PidParams no_d = SpeedParams(0);
+  Pid pid(no_d);
+  NaivePid naive{no_d};
+  for (int i = 0; i < kSamples; i++)
+    CHECK(pid.pidCalc(refs[i], fdbs[i], T) == naive.calc(refs[i], fdbs[i], T));
+
+  PidParams with_d = SpeedParams(0.02f);
+  Pid pid_d(with_d);
+  NaivePid naive_d{with_d};
+  float worst = 0;
+  for (int i = 0; i < kSamples; i++) {
+    float out = pid_d.pidCalc(refs[i], fdbs[i], T);
+    float expect = naive_d.calc(refs[i], fdbs[i], T);
+    float err = fabsf(out - expect);
+    CHECK(err <= 2.4e-7f * fabsf(naive_d.derivative) + 1.2e-7f * fabsf(expect));
+    float ulp = nextafterf(fabsf(expect), INFINITY) - fabsf(expect);
+    if (err / ulp > worst)
+      worst = err / ulp;
+  }
+  printf("Pid: worst output difference %.1f ulp\n", worst);
+}
+
+/*全部功能打开：二自由度、微分滤波、输出会饱和；与参照实现的差别只来自舍入*/
+static PidParams FullParams(PidAntiWindup mode)
+{
+  PidParams params = SpeedParams(0.02f);
+  params.output_limit = 6000.0f;
+  params.anti_windup = mode;
+  params.tracking_gain = 0.5f;
+  params.b = 0.7f;
+  params.c = 0.3f;
+  params.Tf = 0.004f;
+  return params;
+}
+
+static void TestMatchesNaiveFull(void)
+{
+  const float T = 0.001f;
+  const PidAntiWindup modes[] = {kPidWindupClamp, kPidWindupConditional, kPidWindupBackCalc};
+  for (PidAntiWindup mode : modes) {
+    PidParams params = FullParams(mode);
+    Pid pid(params);
+    NaivePid naive{params};
+    float worst = 0;
+    int saturated = 0;
+    for (int i = 0; i < kSamples; i++) {
+      float out = pid.pidCalc(refs[i], fdbs[i], T);
+      float expect = naive.calc(refs[i], fdbs[i], T);
+      float err = fabsf(out - expect) / params.output_limit;
+      if (err > worst)
+        worst = err;
+      saturated += naive.saturated != 0;
+    }
+    printf("Pid: all features, anti-windup %d, %d saturated samples, worst difference %.1e of limit\n",
+           mode, saturated, worst);
+    CHECK(saturated > 0);
+    CHECK(worst < 1e-5f);
+  }
+}
+
+struct StepResult {
+  float rise;        // 第一次到达90%的时刻(s)
+  float noise_rms;   // 稳态段输出相对均值的RMS(A)
+  float worst;       // 与参照实现的最大差别(A)
+};
+
+/*
+ * 100rpm速度阶跃，反馈带±2rpm的均匀噪声(种子固定)；0.5s处采样周期变为1.2ms，
+ * 检查1/(Tf+T)等系数随周期重算。同时运行参照实现，逐拍比较微分递推
+ * D = Tf/(Tf+T)*D' + kd/(Tf+T)*(Δfdb + c*Δref)的结果
+ */
+static StepResult NoisyStep(PidParams params)
+{
+  const float ref = 100.0f;
+  Pid pid(params);
+  NaivePid naive{params};
+  MotorModel motor(200.0f, 0.05f, 10);
+  uint32_t seed = 21;
+  float fdb = 0;
+  float t = 0;
+  double sum = 0, sum2 = 0;
+  int count = 0;
+  StepResult r = {-1, 0, 0};
+  for (int i = 0; i < 1500; i++) {
+    float T = i < 500 ? 0.001f : 0.0012f;
+    seed = seed * 1664525u + 1013904223u;
+    float noise = ((seed >> 8) * (1.0f / 16777216.0f) - 0.5f) * 4.0f;
+    float out = pid.pidCalc(ref, fdb + noise, T);
+    float err = fabsf(out - naive.calc(ref, fdb + noise, T));
+    if (err > r.worst)
+      r.worst = err;
+    fdb = motor.step(out, T);
+    t += T;
+    if (r.rise < 0 && fdb >= 0.9f * ref)
+      r.rise = t;
+    if (i >= 700) {
+      sum += out;
+      sum2 += static_cast<double>(out) * out;
+      count++;
+    }
+  }
+  double mean = sum / count;
+  r.noise_rms = static_cast<float>(sqrt(sum2 / count - mean * mean));
+  return r;
+}
+
+/*二自由度加微分滤波与单自由度比较：输出噪声更小，上升不更慢；两者都与参照实现相符*/
+static void TestTwoDofStep(void)
+{
+  PidParams plain = {0.01f, 0.2f, 0.0002f, 100.0f, 3.0f};
+  plain.separation = 0;
+  PidParams two_dof = plain;
+  two_dof.c = 0.5f;
+  two_dof.Tf = 0.004f;
+  StepResult p = NoisyStep(plain);
+  StepResult d = NoisyStep(two_dof);
+  printf("Pid: 100rpm noisy step, rise/output noise RMS plain %.3fs/%.3fA, b=1 c=0.5 Tf=4ms %.3fs/%.3fA\n",
+         p.rise, p.noise_rms, d.rise, d.noise_rms);
+  CHECK(p.rise > 0 && d.rise > 0);
+  CHECK(d.rise <= p.rise);
+  CHECK(d.noise_rms < 0.5f * p.noise_rms);
+  CHECK(p.worst < 1e-5f && d.worst < 1e-5f);
+}
+
+/*
+ * 闭环运行中用transferParams换参数(kp、ki、b都变)，再对换参数前最后一拍的采样计算：
+ * 新参数下的输出与换参数前的输出只差新积分的一步ki*e*T
+ */
+static void TestTransferParams(void)
+{
+  const float T = 0.001f;
+  const float ref = 100.0f;
+  PidParams a = {0.01f, 0.2f, 0, 100.0f, 3.0f};
+  a.separation = 0;
+  PidParams b = {0.02f, 0.5f, 0, 100.0f, 3.0f};
+  b.separation = 0;
+  b.b = 0.8f;
+  Pid pid(a);
+  MotorModel motor(200.0f, 0.05f, 10);
+  float fdb = 0, last_fdb = 0, out = 0;
+  for (int i = 0; i < 300; i++) {
+    out = pid.pidCalc(ref, fdb, T);
+    last_fdb = fdb;
+    fdb = motor.step(out, T);
+  }
+  pid.transferParams(b);
+  CHECK(pid.getParams().kp == b.kp && pid.getParams().b == b.b);
+  float first = pid.pidCalc(ref, last_fdb, T);
+  CHECK(fabsf(first - out) <= fabsf(b.ki * (ref - last_fdb) * T) + 1e-5f);
+}
+
+/*
+ * 切换控制模式：未启用时按外部给定的电流track()N个周期，切到本控制器后第一拍
+ * (采样与最后一次track相同)的输出与跟踪的输出只差一步积分，微分项没有冲击
+ */
+static void TestTrackSwitch(void)
+{
+  const float T = 0.001f;
+  const float ref = 100.0f;
+  PidParams params = {0.01f, 0.2f, 0.0002f, 100.0f, 3.0f};
+  params.separation = 0;
+  params.b = 0.8f;
+  params.c = 0.5f;
+  params.Tf = 0.004f;
+  const int cycles[] = {1, 10, 200};
+  for (int n : cycles) {
+    Pid pid(params);
+    for (int i = 0; i < 50; i++)       // 先正常运行一段，积分和微分都有状态
+      pid.pidCalc(ref, i * 1.5f, T);
+    MotorModel motor(200.0f, 0.05f, 10);
+    float fdb = 0, last_fdb = 0, u = 0;
+    for (int i = 0; i < n; i++) {
+      u = 1.0f + 0.5f * sinf(i * 0.05f);   // 其它模式给出的电流
+      pid.track(ref, fdb, u);
+      last_fdb = fdb;
+      fdb = motor.step(u, T);
+    }
+    float first = pid.pidCalc(ref, last_fdb, T);
+    CHECK(fabsf(first - u) <= fabsf(params.ki * (ref - last_fdb) * T) + 1e-5f);
+  }
+}
+
+static uint32_t fake_cycles;
+static uint32_t FakeCycles(void) { return fake_cycles; }
+
+/*实测周期在容差内抖动时沿用名义周期的系数，结果与固定周期逐位相同；周期真正变化时按新周期计算*/
+static void TestMeasuredDt(void)
+{
+  const float T = 0.001f;
+  const uint32_t period = 168000;
+  PidParams params = SpeedParams(0.02f);
+  Pid fixed(params);
+  Pid measured(params);
+  DtMeter meter(168000000, FakeCycles);
+  fake_cycles = 0;
+  for (int i = 0; i < kSamples; i++) {
+    fake_cycles += period + (i % 2 ? 1000 : -1000);   // ±0.6%
+    CHECK(measured.pidCalc(refs[i], fdbs[i], meter, T) == fixed.pidCalc(refs[i], fdbs[i], T));
+  }
+
+  fake_cycles += period * 11 / 10;
+  CHECK(measured.pidCalc(refs[0], fdbs[0], meter, T) == fixed.pidCalc(refs[0], fdbs[0], meter.dt()));
+  CHECK(meter.dt() > T * 1.09f);
+}
+
+/*
+ * 电机速度阶跃经过±3A输出限幅，积分限幅放得很宽，只做限幅时积分在上升段大量累积
+ * 返回误差最后一次超出±2%的时刻(s)，peak返回最高转速
+ */
+static float WindupSettle(PidAntiWindup mode, float *peak)
+{
+  const float T = 0.001f;
+  const float ref = 500.0f;   // 稳态需要2.5A，上升段P项就超过3A
+  PidParams params = {0.01f, 0.2f, 0, 100.0f, 3.0f};
+  params.separation = 0;
+  params.anti_windup = mode;
+  params.tracking_gain = 20.0f;
+  Pid pid(params);
+  MotorModel motor(200.0f, 0.05f, 10);
+  float fdb = 0;
+  int settle = 0;
+  *peak = 0;
+  for (int i = 0; i < 3000; i++) {
+    fdb = motor.step(pid.pidCalc(ref, fdb, T), T);
+    if (fabsf(fdb - ref) > 0.02f * ref)
+      settle = i + 1;
+    if (fdb > *peak)
+      *peak = fdb;
+  }
+  return settle * T;
+}
+
+/*条件积分和反算都比只做限幅更快回到稳态，超调更小*/
+static void TestAntiWindup(void)
+{
+  float clamp_peak, cond_peak, back_peak;
+  float clamp = WindupSettle(kPidWindupClamp, &clamp_peak);
+  float cond = WindupSettle(kPidWindupConditional, &cond_peak);
+  float back = WindupSettle(kPidWindupBackCalc, &back_peak);
+  printf("Pid: 500rpm step through 3A limit, settle/peak clamp %.3fs/%.0f, conditional %.3fs/%.0f, back-calc %.3fs/%.0f\n",
+         clamp, clamp_peak, cond, cond_peak, back, back_peak);
+  CHECK(cond < clamp && back < clamp);
+  CHECK(cond_peak < clamp_peak && back_peak < clamp_peak);
+  CHECK(clamp < 3.0f);   // 只做限幅最终也能稳定，比较的是恢复快慢
+}
+
+/*
+ * 反算的修正可能把积分推过限幅：积分已在-1，微分冲击使输出正向饱和
+ * 下一拍的输出用到上一拍留下的积分，修正后没有重新限幅时会远小于-1对应的值
+ */
+static void TestBackCalcClamp(void)
+{
+  const float T = 0.1f;
+  PidParams params = {1.0f, 1.0f, 2.0f, 1.0f, 10.0f};
+  params.separation = 0;
+  params.anti_windup = kPidWindupBackCalc;
+  params.tracking_gain = 1000.0f;
+  Pid pid(params);
+  for (int i = 0; i < 20; i++)
+    pid.pidCalc(0, 5.0f, T);                          // 积分到-1
+  CHECK(pid.pidCalc(0, 4.0f, T) == 10.0f);            // D = 2/0.1*1 = 20，正向饱和
+  float out = pid.pidCalc(0, 4.0f, T);                // 积分 = -1 + (-4-4)/2*0.1
+  CHECK(fabsf(out - (-4.0f - 1.4f)) < 1e-5f);
+}
+
+/*两边功能相同，差别只在系数是否预先算好*/
+static void BenchPid(void)
+{
+  const float T = 0.001f;
+  const char *names[] = {"speed loop", "all features"};
+  PidParams configs[] = {SpeedParams(0.02f), FullParams(kPidWindupBackCalc)};
+  for (int k = 0; k < 2; k++) {
+    Pid pid(configs[k]);
+    NaivePid naive{configs[k]};
+    double pid_ns = BenchNs([&](uint32_t i) { BenchKeep(pid.pidCalc(refs[i % kSamples], fdbs[i % kSamples], T)); }, 1000000);
+    double naive_ns = BenchNs([&](uint32_t i) { BenchKeep(naive.calc(refs[i % kSamples], fdbs[i % kSamples], T)); }, 1000000);
+    printf("Pid: %s, pidCalc %.2f ns/call, divide-every-call reference %.2f ns/call\n", names[k], pid_ns, naive_ns);
+  }
+}
+
+int main(void)
+{
+  MakeSignals();
+  TestMatchesNaive();
+  TestMatchesNaiveFull();
+  TestMeasuredDt();
+  TestAntiWindup();
+  TestTwoDofStep();
+  TestTransferParams();
+  TestTrackSwitch();
+  TestBackCalcClamp();
+  BenchPid();
+  return CHECK_RESULT();
+}
@@ -0,0 +1,114 @@
+/*
+ * 参考信号发生器的主机测试：正弦、扫频与double的sin()比较，非法频率被拒绝
+ */
+#include "RefGen.hpp"
+#include "Check.hpp"
+
+#include <math.h>
+
+static const double kTwoPi = 6.283185307179586;
+
+/*查表插值的正弦在整个相位范围内的误差，头文件给出约7.6e-5*/
+static void TestSinTable(void)
+{
+  double worst = 0;
+  for (uint32_t i = 0; i < (1u << 20); i++) {
+    uint64_t phase = static_cast<uint64_t>(i) << 44;
+    double err = fabs(RefGen_Sin(phase) - sin(kTwoPi * i / (1u << 20)));
+    if (err > worst)
+      worst = err;
+  }
+  printf("RefGen: sine table worst error %.2e\n", worst);
+  CHECK(worst < 8e-5);
+}
+
+/*n很大时精度不下降：与用整数相位算出的sin()比较*/
+static void TestSineLongRun(void)
+{
+  const float T = 0.001f;
+  RefGen gen(T);
+  CHECK(gen.setSine(250.0f, 0.2f));
+  double turns = static_cast<double>(0.2f) * T;   // 与increment相同，频率按float传入
+  double worst = 0;
+  for (uint32_t n = 0xFFFF0000u; n != 0; n++) {   // 运行约49天后的一段
+    double phase = fmod(turns * n, 1.0);
+    double err = fabs(gen.sample(n) - 250.0 * sin(kTwoPi * phase));
+    if (err > worst)
+      worst = err;
+  }
+  CHECK(worst < 250.0 * 8e-5 + 1e-3);
+}
+
+/*扫频的相位 = f0*T*m + (f1-f0)*T/period * m(m-1)/2，向上、向下扫频都要与之相符*/
+static double ChirpWorst(float f0, float f1, float duration)
+{
+  const float T = 0.001f;
+  RefGen gen(T);
+  CHECK(gen.setChirp(1.0f, f0, f1, duration));
+  uint32_t period = static_cast<uint32_t>(duration / T);
+  double t0 = static_cast<double>(f0) * T;
+  double step = (static_cast<double>(f1) * T - t0) / period;
+  double worst = 0;
+  for (uint32_t n = 0; n < 2 * period; n++) {
+    double m = n % period;
+    double phase = fmod(t0 * m + step * m * (m - 1) / 2, 1.0);
+    double err = fabs(gen.sample(n) - sin(kTwoPi * phase));
+    if (err > worst)
+      worst = err;
+  }
+  return worst;
+}
+
+static void TestChirp(void)
+{
+  double up = ChirpWorst(1.0f, 50.0f, 2.0f);
+  double down = ChirpWorst(50.0f, 1.0f, 2.0f);
+  printf("RefGen: chirp worst error up %.2e, down %.2e\n", up, down);
+  CHECK(up < 1e-4);
+  CHECK(down < 1e-4);
+
+  // 向下扫频结束时的瞬时频率接近f1：一个采样走过的相位约f1*T
+  const float T = 0.001f;
+  RefGen gen(T);
+  CHECK(gen.setChirp(1.0f, 50.0f, 1.0f, 2.0f));
+  double a = asin(gen.sample(1997)), b = asin(gen.sample(1998));
+  CHECK(fabs(b - a) < kTwoPi * 2.0 * T);
+}
+
+/*频率为0、负数或不低于奈奎斯特频率时拒绝，原来的波形不变*/
+static void TestRejects(void)
+{
+  const float T = 0.001f;
+  RefGen gen(T);
+  CHECK(gen.setSine(1.0f, 10.0f));
+  float before = gen.sample(37);
+  CHECK(!gen.setSine(2.0f, 0));
+  CHECK(!gen.setSine(2.0f, -5.0f));
+  CHECK(!gen.setSine(2.0f, 500.0f));    // 恰好为奈奎斯特频率
+  CHECK(!gen.setSquare(2.0f, 800.0f));
+  CHECK(!gen.setTriangle(2.0f, 1000.0f));
+  CHECK(!gen.setChirp(2.0f, 1.0f, 600.0f, 1.0f));
+  CHECK(!gen.setChirp(2.0f, 0, 10.0f, 1.0f));
+  CHECK(gen.sample(37) == before);
+  CHECK(gen.setSine(1.0f, 499.0f));
+}
+
+/*next()从第0个采样开始*/
+static void TestNext(void)
+{
+  RefGen gen(0.001f);
+  gen.setStep(3.0f, 2);
+  CHECK(gen.next() == 0);
+  CHECK(gen.next() == 0);
+  CHECK(gen.next() == 3.0f);
+}
+
+int main(void)
+{
+  TestSinTable();
+  TestSineLongRun();
+  TestChirp();
+  TestRejects();
+  TestNext();
+  return CHECK_RESULT();
+}
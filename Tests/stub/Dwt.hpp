@@ -0,0 +1,18 @@
+#ifndef _DWT_H_
+#define _DWT_H_
+
+/*
+ * 主机测试用的Dwt.hpp：周期计数器由测试直接设置，用来模拟CYCCNT的32位回绕
+ */
+#include <stdint.h>
+
+extern uint32_t dwt_stub_cycles;
+
+static inline void Dwt_Init(void) {}
+
+static inline uint32_t Dwt_Cycles(void)
+{
+  return dwt_stub_cycles;
+}
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef __MAIN_H
+#define __MAIN_H
+
+/*
+ * 主机测试用的main.h：只提供不依赖HAL的模块需要的标准头文件
+ * 固件中的main.h由CubeMX生成，包含HAL
+ */
+#include <stdint.h>
+#include <stddef.h>
+
+#endif